@@ -8,6 +8,8 @@
 */
 #include <pico/stdlib.h>
 #include <hardware/i2c.h>
+#include <hardware/dma.h>
+#include <hardware/irq.h>
 #include <pico/binary_info.h>
 #include <stdlib.h>
 #include <string.h>
@@ -16,6 +18,38 @@
 #include "ssd1306.h"
 #include "font.h"
 
+/**
+ * @brief maximum number of command bytes per I2C transaction
+ */
+#define SSD1306_CMD_CHUNK 32
+
+/**
+ * @brief unchanged bytes sent along rather than starting a new run
+ *
+ * a run costs the window commands and two transaction headers
+ */
+#define SSD1306_SHADOW_GAP 10
+
+/**
+ * @brief geometry used by the drawing code
+ *
+ * Constants when SSD1306_WIDTH and SSD1306_HEIGHT are defined at compile
+ * time, so the index math of the pixel kernels folds.
+ */
+#if defined(SSD1306_WIDTH)&&defined(SSD1306_HEIGHT)
+#define SSD1306_W(p) (SSD1306_WIDTH)
+#define SSD1306_H(p) (SSD1306_HEIGHT)
+#else
+#define SSD1306_W(p) ((p)->width)
+#define SSD1306_H(p) ((p)->height)
+#endif
+#define SSD1306_PAGES(p) (SSD1306_H(p)/8)
+
+/**
+ * @brief display owning each DMA channel, consulted by the DMA interrupt
+ */
+static ssd1306_t *ssd1306_dma_owner[NUM_DMA_CHANNELS];
+
 /**
  * @brief swap the values of two integers
  *
@@ -23,707 +57,3568 @@
  * @param b : pointer to the second integer
  */
 inline static void swap(int32_t *a, int32_t *b) {
-    int32_t *t=a;
+    int32_t t=*a;
     *a=*b;
-    *b=*t;
+    *b=t;
+}
+
+/**
+ * @brief load a word from a buffer
+ *
+ * memcpy keeps the access within the aliasing rules, knowing the alignment
+ * the compiler turns it into a single load.
+ *
+ * @param src : 4 byte aligned bytes
+ * @return the bytes as a word in memory order
+ */
+inline static uint32_t ssd1306_load32(const uint8_t *src) {
+    uint32_t v;
+    memcpy(&v, __builtin_assume_aligned(src, 4), sizeof(v));
+    return v;
+}
+
+/**
+ * @brief store a word into a buffer
+ *
+ * @param dst : 4 byte aligned bytes
+ * @param v : word to store in memory order
+ */
+inline static void ssd1306_store32(uint8_t *dst, uint32_t v) {
+    memcpy(__builtin_assume_aligned(dst, 4), &v, sizeof(v));
+}
+
+/**
+	@brief record a failed transfer
+
+	@param p : instance of display
+	@param error : PICO_ERROR_* code of the transfer
+
+*/
+void ssd1306_transfer_error(ssd1306_t *p, int error) {
+    if(p->error==PICO_OK)
+        p->error=error;
+
+    // the display memory is unknown after a failed transfer
+    p->shadow_valid=false;
+
+#ifndef SSD1306_NO_STATS
+    if(error==PICO_ERROR_TIMEOUT)
+        ++(p->stats.timeouts);
+    else
+        ++(p->stats.nacks);
+#endif
+}
+
+/**
+ * @brief count a transfer
+ *
+ * @param p : instance of display
+ * @param n : bytes sent
+ */
+inline static void ssd1306_count_transfer(ssd1306_t *p, size_t n) {
+#ifndef SSD1306_NO_STATS
+    ++(p->stats.transactions);
+    p->stats.bytes+=n;
+#else
+    (void) p;
+    (void) n;
+#endif
+}
+
+#ifndef SSD1306_NO_STATS
+/**
+ * @brief add a duration to statistics
+ *
+ * @param d : statistics of the duration
+ * @param us : duration in microseconds
+ */
+inline static void ssd1306_add_duration(ssd1306_duration_t *d, uint64_t us) {
+    const uint32_t v=us<UINT32_MAX?us:UINT32_MAX;
+
+    if(d->n==0||v<d->min)
+        d->min=v;
+    if(v>d->max)
+        d->max=v;
+    ++(d->n);
+    d->total+=v;
+}
+#endif
+
+/**
+ * @brief start a frame: count it and time the rendering that led to it
+ *
+ * @param p : instance of display
+ * @return time_us_64 at the start of the frame, 0 without statistics
+ */
+inline static uint64_t ssd1306_frame_begin(ssd1306_t *p) {
+#ifndef SSD1306_NO_STATS
+    const uint64_t now=time_us_64();
+    ++(p->stats.frames);
+    if(p->stats.last_show)
+        ssd1306_add_duration(&p->stats.render, now-p->stats.last_show);
+    return now;
+#else
+    (void) p;
+    return 0;
+#endif
+}
+
+/**
+ * @brief get and clear the first error since the last show
+ *
+ * @param p : instance of display
+ * @return PICO_OK or the PICO_ERROR_* code
+ */
+inline static int ssd1306_take_error(ssd1306_t *p) {
+    const int error=p->error;
+    p->error=PICO_OK;
+    return error;
+}
+
+/**
+ * @brief end a frame
+ *
+ * @param p : instance of display
+ * @param start : value of ssd1306_frame_begin
+ * @param timed : whether the frame was sent blocking, so the time since start is the transfer time
+ */
+inline static void ssd1306_frame_end(ssd1306_t *p, uint64_t start, bool timed) {
+#ifndef SSD1306_NO_STATS
+    p->stats.last_show=time_us_64();
+    if(timed)
+        ssd1306_add_duration(&p->stats.transfer, p->stats.last_show-start);
+#else
+    (void) p;
+    (void) start;
+    (void) timed;
+#endif
+}
+
+/**
+ * @brief write to the display over I2C, recording failures
+ *
+ * Define SSD1306_I2C_TIMEOUT_US to give up on a byte stuck for that long
+ * instead of waiting forever.
+ *
+ * @param p : instance of display
+ * @param src : control byte and its data
+ * @param len : number of bytes in src
+ */
+inline static void ssd1306_i2c_write(ssd1306_t *p, const uint8_t *src, size_t len) {
+#ifdef SSD1306_I2C_TIMEOUT_US
+    const int res=i2c_write_timeout_per_char_us(p->i2c_i, p->address, src, len, false, SSD1306_I2C_TIMEOUT_US);
+#else
+    const int res=i2c_write_blocking(p->i2c_i, p->address, src, len, false);
+#endif
+
+    if(res<0)
+        ssd1306_transfer_error(p, res);
+}
+
+/**
+	@brief write a sequence of commands to the display
+
+	@param p : instance of display
+	@param cmds : commands and their arguments
+	@param n : number of bytes in cmds
+
+*/
+void ssd1306_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    ssd1306_count_transfer(p, n);
+    p->transport->write_cmds(p, cmds, n);
+}
+
+/**
+ * @brief send display data through the transport of the display
+ *
+ * @param p : instance of display
+ * @param data : display data, data[-1] must be writable
+ * @param n : number of bytes in data
+ */
+inline static void ssd1306_write_data(ssd1306_t *p, uint8_t *data, size_t n) {
+    ssd1306_count_transfer(p, n);
+    p->transport->write_data(p, data, n);
+}
+
+/**
+ * @brief send commands over I2C, each chunk behind a command control byte
+ *
+ * @param p : instance of display
+ * @param cmds : commands and their arguments
+ * @param n : number of bytes in cmds
+ */
+static void ssd1306_i2c_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    uint8_t d[1+SSD1306_CMD_CHUNK];
+    d[0]=SET_COMMAND_MODE;
+
+    while(n) {
+        size_t len=n<SSD1306_CMD_CHUNK?n:SSD1306_CMD_CHUNK;
+        memcpy(d+1, cmds, len);
+        ssd1306_i2c_write(p, d, len+1);
+        cmds+=len;
+        n-=len;
+    }
+}
+
+/**
+ * @brief send display data over I2C
+ *
+ * The 0x40 control byte is written in front of the data, the overwritten
+ * byte is restored afterwards, so no copy is needed.
+ *
+ * @param p : instance of display
+ * @param data : display data, data[-1] must be writable
+ * @param n : number of bytes in data
+ */
+static void ssd1306_i2c_write_data(ssd1306_t *p, uint8_t *data, size_t n) {
+    uint8_t saved=*(data-1);
+    *(data-1)=0x40;
+    ssd1306_i2c_write(p, data-1, n+1);
+    *(data-1)=saved;
+}
+
+/**
+ * @brief write a single byte to the display
+ *
+ * @param p : instance of display
+ * @param val : byte to be written
+ */
+inline static void ssd1306_write(ssd1306_t *p, uint8_t val) {
+    ssd1306_write_cmds(p, &val, 1);
+}
+
+/**
+ * @brief forget all pending changes of the display buffer
+ *
+ * @param p : instance of display
+ */
+inline static void ssd1306_reset_dirty(ssd1306_t *p) {
+    p->dirty_x0=0xFF;
+    p->dirty_x1=0;
+    p->dirty_p0=0xFF;
+    p->dirty_p1=0;
+}
+
+/**
+ * @brief check whether ssd1306_show_bands renders a band into p->buffer
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true if p->buffer only holds the pages band_p0 to band_p1
+ */
+inline static bool ssd1306_in_band(const ssd1306_t *p) {
+    return p->band_p0<=p->band_p1;
+}
+
+/**
+ * @brief cut the clip rectangle to the rows of the band being rendered
+ *
+ * @param p : instance of display
+ */
+inline static void ssd1306_clip_band(ssd1306_t *p) {
+    if(!ssd1306_in_band(p))
+        return;
+
+    if(p->clip_y0<p->band_p0<<3)
+        p->clip_y0=p->band_p0<<3;
+    if(p->clip_y1>(p->band_p1<<3)+7)
+        p->clip_y1=(p->band_p1<<3)+7;
+}
+
+/**
+ * @brief extend the dirty area by the given columns and pages
+ *
+ * @param p : instance of display
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+inline static void ssd1306_mark_dirty(ssd1306_t *p, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(x0<p->dirty_x0) p->dirty_x0=x0;
+    if(x1>p->dirty_x1) p->dirty_x1=x1;
+    if(p0<p->dirty_p0) p->dirty_p0=p0;
+    if(p1>p->dirty_p1) p->dirty_p1=p1;
 }
 
 /**
- * @brief write data to an I2C device with error handling
+ * @brief get the clip rectangle in display coordinates
  *
- * @param i2c : pointer to the I2C instance
- * @param addr : address of the I2C device
- * @param src : pointer to the data to be written
- * @param len : length of the data to be written
- * @param name : name of the I2C device (for error messages)
+ * @param p : instance of display
+ * @param x0 : first visible x position
+ * @param y0 : first visible y position
+ * @param x1 : last visible x position
+ * @param y1 : last visible y position
  */
-inline static void fancy_write(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, char *name) {
-    switch(i2c_write_blocking(i2c, addr, src, len, false)) {
-    case PICO_ERROR_GENERIC:
-        printf("[%s] addr not acknowledged!\n", name);
+static void ssd1306_get_clip(ssd1306_t *p, int32_t *x0, int32_t *y0, int32_t *x1, int32_t *y1) {
+    const int32_t w=SSD1306_W(p), h=SSD1306_H(p);
+
+    switch(p->rotation) {
+    case 0:
+        *x0=p->clip_x0, *x1=p->clip_x1, *y0=p->clip_y0, *y1=p->clip_y1;
+        break;
+    case 1:
+        *x0=p->clip_y0, *x1=p->clip_y1, *y0=w-1-p->clip_x1, *y1=w-1-p->clip_x0;
         break;
-    case PICO_ERROR_TIMEOUT:
-        printf("[%s] timeout!\n", name);
+    case 2:
+        *x0=w-1-p->clip_x1, *x1=w-1-p->clip_x0, *y0=h-1-p->clip_y1, *y1=h-1-p->clip_y0;
         break;
     default:
-        printf("[%s] wrote successfully %lu bytes!\n", name, len);
+        *x0=h-1-p->clip_y1, *x1=h-1-p->clip_y0, *y0=p->clip_x0, *y1=p->clip_x1;
         break;
     }
 }
 
 /**
- * @brief write a single byte to the display
+ * @brief bits of a page inside of the clip rectangle
  *
  * @param p : instance of display
- * @param val : byte to be written
+ * @param page : page of buffer
  */
-inline static void ssd1306_write(ssd1306_t *p, uint8_t val) {
-    uint8_t d[2]= {0x00, val};
-    i2c_write_blocking(p->i2c_i, p->address, d, 2, false);
+inline static uint8_t ssd1306_clip_mask(ssd1306_t *p, uint32_t page) {
+    uint8_t mask=0xFF;
+    if(page==p->clip_y0>>3u)
+        mask&=0xFF<<(p->clip_y0&7);
+    if(page==p->clip_y1>>3u)
+        mask&=0xFF>>(7-(p->clip_y1&7));
+    if(page<p->clip_y0>>3u||page>p->clip_y1>>3u)
+        mask=0;
+    return mask;
 }
 
 /**
-*	@brief initialize display
-*
-*	@param p : instance of display
-*	@param width : width of display
-*	@param height : heigth of display
-*	@param address : i2c address of display
-*	@param i2c_instance : instance of i2c connection
-*	
-* 	@return bool.
-*	@retval true for Success
-*	@retval false if initialization failed
-*/
-bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
-    p->width=width;
-    p->height=height;
-    p->pages=height/8;
-    p->address=address;
+ * @brief pixel kernel, plots one pixel of a fixed rotation
+ */
+typedef void (*ssd1306_pixel_fn_t)(ssd1306_t *p, uint32_t x, uint32_t y);
 
-    p->i2c_i=i2c_instance;
+/**
+ * @brief set, clear or invert a pixel given in buffer coordinates
+ *
+ * @param p : instance of display
+ * @param bx : column in buffer
+ * @param by : row in buffer
+ * @param mode : SSD1306_DRAW_* operation
+ */
+inline static void ssd1306_plot(ssd1306_t *p, uint32_t bx, uint32_t by, uint8_t mode) {
+    if(bx>=p->clip_x0 && bx<=p->clip_x1 && by>=p->clip_y0 && by<=p->clip_y1) {
+        uint8_t *dst=&p->buffer[bx + SSD1306_W(p) * (by >> 3)];
+        const uint8_t bit=0x1 << (by & 0x07);
+        switch(mode) {
+        case SSD1306_DRAW_SET:
+            *dst |= bit;
+            break;
+        case SSD1306_DRAW_CLEAR:
+            *dst &= ~bit;
+            break;
+        case SSD1306_DRAW_XOR:
+            *dst ^= bit;
+            break;
+        }
+        ssd1306_mark_dirty(p, bx, bx, by >> 3, by >> 3);
+    }
+}
+
+/**
+ * @brief define the pixel kernels of a rotation, one per drawing mode
+ */
+#define SSD1306_PIXEL_KERNELS(r, bx, by) \
+    static void ssd1306_set_pixel_r##r(ssd1306_t *p, uint32_t x, uint32_t y) { \
+        ssd1306_plot(p, bx, by, SSD1306_DRAW_SET); \
+    } \
+    static void ssd1306_clear_pixel_r##r(ssd1306_t *p, uint32_t x, uint32_t y) { \
+        ssd1306_plot(p, bx, by, SSD1306_DRAW_CLEAR); \
+    } \
+    static void ssd1306_xor_pixel_r##r(ssd1306_t *p, uint32_t x, uint32_t y) { \
+        ssd1306_plot(p, bx, by, SSD1306_DRAW_XOR); \
+    }
 
+SSD1306_PIXEL_KERNELS(0, x, y)
+SSD1306_PIXEL_KERNELS(1, SSD1306_W(p) - 1 - y, x)
+SSD1306_PIXEL_KERNELS(2, SSD1306_W(p) - 1 - x, SSD1306_H(p) - 1 - y)
+SSD1306_PIXEL_KERNELS(3, y, SSD1306_H(p) - 1 - x)
 
-    p->bufsize=(p->pages)*(p->width);
-    if((p->buffer=malloc(p->bufsize+1))==NULL) {
-        p->bufsize=0;
-        return false;
+/**
+ * @brief pixel kernels indexed by rotation and drawing mode
+ */
+static const ssd1306_pixel_fn_t ssd1306_pixel_fns[4][3]= {
+    {ssd1306_set_pixel_r0, ssd1306_clear_pixel_r0, ssd1306_xor_pixel_r0},
+    {ssd1306_set_pixel_r1, ssd1306_clear_pixel_r1, ssd1306_xor_pixel_r1},
+    {ssd1306_set_pixel_r2, ssd1306_clear_pixel_r2, ssd1306_xor_pixel_r2},
+    {ssd1306_set_pixel_r3, ssd1306_clear_pixel_r3, ssd1306_xor_pixel_r3},
+};
+
+/**
+ * @brief apply a bit mask to a run of buffer bytes
+ *
+ * @param row : first byte
+ * @param n : number of bytes
+ * @param mask : bits to change in every byte
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_span(uint8_t *row, size_t n, uint8_t mask, uint8_t mode) {
+    if(mask==0xFF&&mode!=SSD1306_DRAW_XOR) {
+        memset(row, mode==SSD1306_DRAW_SET?0xFF:0x00, n);
+        return;
     }
 
-    ++(p->buffer);
+    const uint32_t mask32=mask*0x01010101u;
 
-    // from https://github.com/makerportal/rpi-pico-ssd1306
-    uint8_t cmds[]= {
-        SET_DISP,
-        // timing and driving scheme
-        SET_DISP_CLK_DIV,
-        0x80,
-        SET_MUX_RATIO,
-        height - 1,
-        SET_DISP_OFFSET,
-        0x00,
-        // resolution and layout
-        SET_DISP_START_LINE,
-        // charge pump
-        SET_CHARGE_PUMP,
-        p->external_vcc?0x10:0x14,
-        SET_SEG_REMAP | 0x01,           // column addr 127 mapped to SEG0
-        SET_COM_OUT_DIR | 0x08,         // scan from COM[N] to COM0
-        SET_COM_PIN_CFG,
-        width>2*height?0x02:0x12,
-        // display
-        SET_CONTRAST,
-        0xff,
-        SET_PRECHARGE,
-        p->external_vcc?0x22:0xF1,
-        SET_VCOM_DESEL,
-        0x30,                           // or 0x40?
-        SET_ENTIRE_ON,                  // output follows RAM contents
-        SET_NORM_INV,                   // not inverted
-        SET_DISP | 0x01,
-        // address setting
-        SET_MEM_ADDR,
-        0x00,  // horizontal
-    };
+    for(; n&&((uintptr_t) row&3); --n, ++row)
+        *row=mode==SSD1306_DRAW_SET?*row|mask:mode==SSD1306_DRAW_CLEAR?*row&~mask:*row^mask;
 
-    for(size_t i=0; i<sizeof(cmds); ++i)
-        ssd1306_write(p, cmds[i]);
+    switch(mode) {
+    case SSD1306_DRAW_SET:
+        for(; n>=4; n-=4, row+=4)
+            ssd1306_store32(row, ssd1306_load32(row)|mask32);
+        break;
+    case SSD1306_DRAW_CLEAR:
+        for(; n>=4; n-=4, row+=4)
+            ssd1306_store32(row, ssd1306_load32(row)&~mask32);
+        break;
+    case SSD1306_DRAW_XOR:
+        for(; n>=4; n-=4, row+=4)
+            ssd1306_store32(row, ssd1306_load32(row)^mask32);
+        break;
+    }
+
+    for(; n; --n, ++row)
+        *row=mode==SSD1306_DRAW_SET?*row|mask:mode==SSD1306_DRAW_CLEAR?*row&~mask:*row^mask;
+}
+
+/**
+ * @brief set or clear a rectangle given in buffer coordinates
+ *
+ * @param p : instance of display
+ * @param bx0 : first column
+ * @param by0 : first row
+ * @param bx1 : column after the last one
+ * @param by1 : row after the last one
+ * @param mode : SSD1306_DRAW_* operation
+ * @note the rectangle must lie inside of the buffer and must not be empty
+ */
+static void ssd1306_fill_buffer_rect(ssd1306_t *p, uint32_t bx0, uint32_t by0, uint32_t bx1, uint32_t by1, uint8_t mode) {
+    const uint32_t page0=by0>>3, page1=(by1-1)>>3;
+
+    for(uint32_t page=page0; page<=page1; ++page) {
+        uint8_t mask=0xFF;
+        if(page==page0)
+            mask&=0xFF<<(by0&7);
+        if(page==page1)
+            mask&=0xFF>>(7-((by1-1)&7));
+
+        ssd1306_span(p->buffer+page*SSD1306_W(p)+bx0, bx1-bx0, mask, mode);
+    }
+
+    ssd1306_mark_dirty(p, bx0, bx1-1, page0, page1);
+}
+
+/**
+ * @brief set or clear a rectangle given in display coordinates
+ *
+ * The rectangle is clipped and transformed to buffer coordinates once,
+ * the pixels are then written page by page.
+ *
+ * @param p : instance of display
+ * @param x : x position of starting point
+ * @param y : y position of starting point
+ * @param width : width of rectangle
+ * @param height : height of rectangle
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_fill_rect(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint8_t mode) {
+    const uint32_t w=SSD1306_W(p), h=SSD1306_H(p);
+    const uint32_t lw=p->rotation&1?h:w, lh=p->rotation&1?w:h;
+
+    if(x>=lw||y>=lh||width==0||height==0)
+        return;
+    if(width>lw-x)
+        width=lw-x;
+    if(height>lh-y)
+        height=lh-y;
+
+    uint32_t bx0, by0, bx1, by1;
+    switch(p->rotation) {
+    case 0:
+        bx0=x, by0=y, bx1=x+width, by1=y+height;
+        break;
+    case 1:
+        bx0=w-y-height, by0=x, bx1=w-y, by1=x+width;
+        break;
+    case 2:
+        bx0=w-x-width, by0=h-y-height, bx1=w-x, by1=h-y;
+        break;
+    default:
+        bx0=y, by0=h-x-width, bx1=y+height, by1=h-x;
+        break;
+    }
+
+    if(bx0<p->clip_x0)
+        bx0=p->clip_x0;
+    if(by0<p->clip_y0)
+        by0=p->clip_y0;
+    if(bx1>p->clip_x1+1u)
+        bx1=p->clip_x1+1u;
+    if(by1>p->clip_y1+1u)
+        by1=p->clip_y1+1u;
+
+    if(bx0<bx1&&by0<by1)
+        ssd1306_fill_buffer_rect(p, bx0, by0, bx1, by1, mode);
+}
+
+/**
+ * @brief set or clear a horizontal run of pixels given in display coordinates
+ *
+ * @param p : instance of display
+ * @param x0 : first x position
+ * @param x1 : last x position
+ * @param y : y position
+ * @param mode : SSD1306_DRAW_* operation
+ */
+inline static void ssd1306_hspan(ssd1306_t *p, int32_t x0, int32_t x1, int32_t y, uint8_t mode) {
+    if(y<0||x1<0||x0>x1)
+        return;
+    if(x0<0)
+        x0=0;
+    ssd1306_fill_rect(p, x0, y, x1-x0+1, 1, mode);
+}
+
+/**
+ * @brief build the commands addressing a window of the display
+ *
+ * @param p : instance of display
+ * @param cmds : destination for the 6 command bytes
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+inline static void ssd1306_window_cmds(ssd1306_t *p, uint8_t *cmds, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(SSD1306_W(p)==64) {
+        x0+=32;
+        x1+=32;
+    }
+
+    cmds[0]=SET_COL_ADDR;
+    cmds[1]=x0;
+    cmds[2]=x1;
+    cmds[3]=SET_PAGE_ADDR;
+    cmds[4]=p0;
+    cmds[5]=p1;
+}
+
+/**
+ * @brief get a byte of display memory for the current start line
+ *
+ * The display memory is a ring of 64 rows, buffer row y is stored in row
+ * (y+start_line)%64, so a memory page holds parts of two buffer pages.
+ *
+ * @param p : instance of display
+ * @param src : frame
+ * @param q : memory page
+ * @param x : column
+ * @return byte to store in page q, column x
+ */
+inline static uint8_t ssd1306_ram_byte(ssd1306_t *p, const uint8_t *src, uint32_t q, uint32_t x) {
+    const uint32_t a=p->start_line>>3, s=p->start_line&7;
+    const uint32_t k=(q-a)&7, kp=(k-1)&7;
+
+    uint8_t b=k<p->pages?src[k*p->width+x]<<s:0;
+    if(s&&kp<p->pages)
+        b|=src[kp*p->width+x]>>(8-s);
+
+    return b;
+}
+
+/**
+ * @brief send a window of the display buffer while the start line is moved
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+static void ssd1306_show_ring(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    uint8_t row[1+128];
+    uint32_t n=p1-p0+1+((p->start_line&7)!=0);
+    if(n>8)
+        n=8;
+
+    for(uint32_t q=p0+(p->start_line>>3); n; --n, ++q) {
+        uint8_t payload[6];
+        ssd1306_window_cmds(p, payload, x0, x1, q&7, q&7);
+        ssd1306_write_cmds(p, payload, sizeof(payload));
+
+        for(uint32_t x=x0; x<=x1; ++x)
+            row[1+x-x0]=ssd1306_ram_byte(p, src, q&7, x);
+        ssd1306_write_data(p, row+1, x1-x0+1);
+    }
+}
+
+/**
+ * @brief send a window of the display buffer to the display
+ *
+ * @param p : instance of display
+ * @param src : frame to send, src[-1] must be writable
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+static void ssd1306_show_window(ssd1306_t *p, uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(p->start_line) {
+        ssd1306_show_ring(p, src, x0, x1, p0, p1);
+        return;
+    }
+
+    uint8_t payload[6];
+    ssd1306_window_cmds(p, payload, x0, x1, p0, p1);
+
+    ssd1306_write_cmds(p, payload, sizeof(payload));
+
+    size_t len=x1-x0+1;
+    size_t rows=p1-p0+1;
+    if(len==p->width) { // full rows are contiguous in the buffer
+        len*=rows;
+        rows=1;
+    }
+
+    for(uint8_t *row=src+p0*p->width+x0; rows; --rows, row+=p->width)
+        ssd1306_write_data(p, row, len);
+}
+
+/**
+ * @brief find the first byte in which two frames differ
+ *
+ * Compares a word at a time when both frames have the same alignment.
+ *
+ * @param a : first frame
+ * @param b : second frame
+ * @param i : index to start at
+ * @param n : index to stop at
+ * @return index of the first differing byte, n if there is none
+ */
+inline static uint32_t ssd1306_diff_next(const uint8_t *a, const uint8_t *b, uint32_t i, uint32_t n) {
+    if((((uintptr_t) a^(uintptr_t) b)&3)==0) {
+        for(; i<n&&((uintptr_t) (a+i)&3); ++i)
+            if(a[i]!=b[i])
+                return i;
+        while(i+4<=n&&ssd1306_load32(a+i)==ssd1306_load32(b+i))
+            i+=4;
+    }
+
+    while(i<n&&a[i]==b[i])
+        ++i;
+
+    return i;
+}
+
+/**
+ * @brief record a window of a frame as sent to the display memory
+ *
+ * @param p : instance of display
+ * @param src : frame that was sent
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+static void ssd1306_shadow_sent(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(p->shadow==NULL)
+        return;
+
+    if(x0==0&&x1==p->width-1u) {
+        memcpy(p->shadow+p0*p->width, src+p0*p->width, (p1-p0+1)*p->width);
+        if(p0==0&&p1==p->pages-1u) // not while an error of this or an async frame is pending
+            p->shadow_valid=p->error==PICO_OK;
+        return;
+    }
+
+    for(uint32_t page=p0; page<=p1; ++page)
+        memcpy(p->shadow+page*p->width+x0, src+page*p->width+x0, x1-x0+1);
+}
+
+/**
+ * @brief send a window of a frame, skipping bytes the display already shows
+ *
+ * Without a valid shadow the whole frame is sent. Otherwise each page is
+ * sent as runs of changed bytes, runs closer than SSD1306_SHADOW_GAP are
+ * sent as one.
+ *
+ * @param p : instance of display
+ * @param src : frame to send, src[-1] must be writable
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ */
+static void ssd1306_show_diff(ssd1306_t *p, uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(p->shadow==NULL) {
+        ssd1306_show_window(p, src, x0, x1, p0, p1);
+        return;
+    }
+
+    if(!p->shadow_valid) {
+        ssd1306_show_window(p, src, 0, p->width-1, 0, p->pages-1);
+        ssd1306_shadow_sent(p, src, 0, p->width-1, 0, p->pages-1);
+        return;
+    }
+
+    for(uint32_t page=p0; page<=p1; ++page) {
+        const uint8_t *s=p->shadow+page*p->width;
+        const uint8_t *d=src+page*p->width;
+
+        for(uint32_t x=ssd1306_diff_next(s, d, x0, x1+1); x<=x1;) {
+            const uint32_t a=x;
+            uint32_t b=x;
+            while((x=ssd1306_diff_next(s, d, b+1, x1+1))<=x1&&x-b<=SSD1306_SHADOW_GAP)
+                b=x;
+
+            ssd1306_show_window(p, src, a, b, page, page);
+            ssd1306_shadow_sent(p, src, a, b, page, page);
+        }
+    }
+}
+
+static size_t ssd1306_i2c_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1);
+static bool ssd1306_i2c_is_busy(ssd1306_t *p);
+
+/**
+ * @brief transport of displays set up with ssd1306_init
+ */
+static const ssd1306_transport_t ssd1306_i2c_transport= {
+    .write_cmds=ssd1306_i2c_write_cmds,
+    .write_data=ssd1306_i2c_write_data,
+    .start_async=ssd1306_i2c_start_async,
+    .is_busy=ssd1306_i2c_is_busy,
+};
+
+/**
+*	@brief initialize display
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param address : i2c address of display
+*	@param i2c_instance : instance of i2c connection
+*	
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
+*/
+bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance) {
+    p->address=address;
+    p->i2c_i=i2c_instance;
+    p->spi_i=NULL;
+    p->pio=NULL;
+    p->bus=i2c_instance;
+
+    return ssd1306_init_with_transport(p, width, height, &ssd1306_i2c_transport, NULL);
+}
+
+/**
+*	@brief initialize display without allocating its buffer
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param address : i2c address of display
+*	@param i2c_instance : instance of i2c connection
+*	@param buffer : SSD1306_BUFFER_SIZE(width, height) bytes, kept by the display until ssd1306_deinit
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64
+*/
+bool ssd1306_init_with_buffer(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance, uint8_t *buffer) {
+    p->address=address;
+    p->i2c_i=i2c_instance;
+    p->spi_i=NULL;
+    p->pio=NULL;
+    p->bus=i2c_instance;
+
+    return ssd1306_init_with_transport(p, width, height, &ssd1306_i2c_transport, buffer);
+}
+
+/**
+*	@brief initialize display connected through a custom transport
+*
+*	@param p : instance of display, with the fields used by the transport set
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param transport : operations sending commands and data
+*	@param buffer : SSD1306_BUFFER_SIZE(width, height) bytes, NULL to allocate them
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
+*/
+bool ssd1306_init_with_transport(ssd1306_t *p, uint16_t width, uint16_t height, const ssd1306_transport_t *transport, uint8_t *buffer) {
+#if defined(SSD1306_WIDTH)&&defined(SSD1306_HEIGHT)
+    if(width!=SSD1306_WIDTH||height!=SSD1306_HEIGHT)
+        return false;
+#endif
+    // the controller has 128 columns and a ring of 64 rows, row buffers are sized for that
+    if(width>128||height>64)
+        return false;
+
+    p->width=width;
+    p->height=height;
+    p->pages=height/8;
+    p->transport=transport;
+
+    p->bufsize=(p->pages)*(p->width);
+    p->user_buffer=buffer?buffer+1:NULL;
+    if(buffer==NULL&&(buffer=malloc(p->bufsize+1))==NULL) {
+        p->bufsize=0;
+        return false;
+    }
+
+    p->buffer=buffer+1;
+    p->band_p0=0xFF;
+    p->band_p1=0;
+    ssd1306_reset_dirty(p);
+    p->mode = SSD1306_DRAW_SET;
+    ssd1306_set_rotation(p, 0); // also resets the clip rectangle
+
+    p->front=NULL;
+    p->shadow=NULL;
+    p->shadow_valid=false;
+    p->start_line=0;
+    p->dma_chan=-1;
+    p->dma_buf=NULL;
+    p->dma_size=0;
+    p->show_cb=NULL;
+    p->glyph_cache=NULL;
+    p->error=PICO_OK;
+#ifndef SSD1306_NO_STATS
+    ssd1306_reset_stats(p);
+#endif
+
+    // from https://github.com/makerportal/rpi-pico-ssd1306
+    uint8_t cmds[]= {
+        SET_DISP,
+        // timing and driving scheme
+        SET_DISP_CLK_DIV,
+        0x80,
+        SET_MUX_RATIO,
+        height - 1,
+        SET_DISP_OFFSET,
+        0x00,
+        // resolution and layout
+        SET_DISP_START_LINE,
+        // charge pump
+        SET_CHARGE_PUMP,
+        p->external_vcc?0x10:0x14,
+        SET_SEG_REMAP | 0x01,           // column addr 127 mapped to SEG0
+        SET_COM_OUT_DIR | 0x08,         // scan from COM[N] to COM0
+        SET_COM_PIN_CFG,
+        width>2*height?0x02:0x12,
+        // display
+        SET_CONTRAST,
+        0xff,
+        SET_PRECHARGE,
+        p->external_vcc?0x22:0xF1,
+        SET_VCOM_DESEL,
+        0x30,                           // or 0x40?
+        SET_ENTIRE_ON,                  // output follows RAM contents
+        SET_NORM_INV,                   // not inverted
+        SET_DISP | 0x01,
+        // address setting
+        SET_MEM_ADDR,
+        0x00,  // horizontal
+    };
+
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+
+    return true;
+}
+
+/**
+*	@brief deinitialize display
+*
+*	@param p : instance of display
+*
+*/
+inline void ssd1306_deinit(ssd1306_t *p) {
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    if(p->dma_chan>=0) {
+        dma_channel_set_irq0_enabled(p->dma_chan, false);
+        ssd1306_dma_owner[p->dma_chan]=NULL;
+        dma_channel_unclaim(p->dma_chan);
+        p->dma_chan=-1;
+    }
+
+    free(p->dma_buf);
+    p->dma_buf=NULL;
+    p->dma_size=0;
+
+    // after swapping, the caller's buffer may be either of them
+    if(p->front&&p->front!=p->user_buffer)
+        free(p->front-1);
+    if(p->buffer!=p->user_buffer)
+        free(p->buffer-1);
+    p->front=NULL;
+
+    if(p->shadow)
+        free(p->shadow-1);
+    p->shadow=NULL;
+}
+
+/**
+*	@brief turn off display
+*
+*	@param p : instance of display
+*
+*/
+inline void ssd1306_poweroff(ssd1306_t *p) {
+    ssd1306_write(p, SET_DISP|0x00);
+}
+
+/**
+	@brief turn on display
+
+	@param p : instance of display
+
+*/
+inline void ssd1306_poweron(ssd1306_t *p) {
+    ssd1306_write(p, SET_DISP|0x01);
+}
+
+/**
+	@brief set contrast of display
+
+	@param p : instance of display
+	@param val : contrast
+
+*/
+inline void ssd1306_contrast(ssd1306_t *p, uint8_t val) {
+    uint8_t cmds[]= {SET_CONTRAST, val};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+/**
+	@brief set invert display
+
+	@param p : instance of display
+	@param inv : inv==0: disable inverting, inv!=0: invert
+
+*/
+inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
+    ssd1306_write(p, SET_NORM_INV | (inv & 1));
+}
+
+/**
+	@brief set vertical flip of display
+
+	@param p : instance of display
+	@param val : val==0: disable flip, val!=0: flip
+
+*/
+inline void ssd1306_vflip(ssd1306_t *p, uint8_t val) {
+    ssd1306_write(p, SET_COM_OUT_DIR | (!val << 3));
+}
+
+/**
+	@brief set horizontal flop of display
+
+	@param p : instance of display
+	@param val : val==0: disable flop, val!=0: flop
+
+*/
+inline void ssd1306_hflip(ssd1306_t *p, uint8_t val) {
+    ssd1306_write(p, SET_SEG_REMAP | (!val & 1));
+}
+
+/**
+	@brief Outdated: set hardware rotation of display to 180°
+
+	@param p : instance of display
+	@param val : val==0: disable rotation, val!=0: rotate
+	@note Included for backwards support. Use ssd1306_set_rotation instead
+
+*/
+inline void ssd1306_rotate(ssd1306_t *p, uint8_t val) {
+    uint8_t cmds[]= {SET_COM_OUT_DIR | (!val << 3), SET_SEG_REMAP | (!val & 1)};
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+}
+
+/**
+	@brief set display rotation
+
+	@param p : instance of display
+	@param rotation : 0: no rotation, 1: 90°, 2: 180°, 3: 270°
+
+*/
+inline void ssd1306_set_rotation(ssd1306_t *p, uint8_t rotation) {
+    if(rotation > 3) {
+        return;
+    }
+
+    p->rotation = rotation;
+    p->draw_pixel_fn = ssd1306_pixel_fns[rotation][p->mode];
+    p->clear_pixel_fn = ssd1306_pixel_fns[rotation][SSD1306_DRAW_CLEAR];
+    ssd1306_reset_clip(p);
+}
+
+/**
+	@brief set the operation used by the draw functions
+
+	@param p : instance of display
+	@param mode : SSD1306_DRAW_SET, SSD1306_DRAW_CLEAR or SSD1306_DRAW_XOR
+	@note the clear functions always clear, whatever the mode
+
+*/
+inline void ssd1306_set_draw_mode(ssd1306_t *p, ssd1306_draw_mode_t mode) {
+    if(mode > SSD1306_DRAW_XOR) {
+        return;
+    }
+
+    p->mode = mode;
+    p->draw_pixel_fn = ssd1306_pixel_fns[p->rotation][mode];
+}
+
+/**
+	@brief restrict drawing to a rectangle
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of rectangle
+	@param height : height of rectangle
+
+*/
+void ssd1306_set_clip(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    const uint32_t w=SSD1306_W(p), h=SSD1306_H(p);
+    const uint32_t lw=p->rotation&1?h:w, lh=p->rotation&1?w:h;
+
+    if(x>=lw||y>=lh||width==0||height==0) { // nothing visible
+        p->clip_x0=p->clip_y0=1;
+        p->clip_x1=p->clip_y1=0;
+        return;
+    }
+    if(width>lw-x)
+        width=lw-x;
+    if(height>lh-y)
+        height=lh-y;
+
+    switch(p->rotation) {
+    case 0:
+        p->clip_x0=x, p->clip_x1=x+width-1, p->clip_y0=y, p->clip_y1=y+height-1;
+        break;
+    case 1:
+        p->clip_x0=w-y-height, p->clip_x1=w-1-y, p->clip_y0=x, p->clip_y1=x+width-1;
+        break;
+    case 2:
+        p->clip_x0=w-x-width, p->clip_x1=w-1-x, p->clip_y0=h-y-height, p->clip_y1=h-1-y;
+        break;
+    case 3:
+        p->clip_x0=y, p->clip_x1=y+height-1, p->clip_y0=h-x-width, p->clip_y1=h-1-x;
+        break;
+    }
+
+    ssd1306_clip_band(p);
+}
+
+/**
+	@brief allow drawing on the whole display again
+
+	@param p : instance of display
+
+*/
+inline void ssd1306_reset_clip(ssd1306_t *p) {
+    p->clip_x0=p->clip_y0=0;
+    p->clip_x1=SSD1306_W(p)-1;
+    p->clip_y1=SSD1306_H(p)-1;
+    ssd1306_clip_band(p);
+}
+
+/**
+	@brief clear display buffer
+
+	@param p : instance of display
+
+*/
+void ssd1306_clear(ssd1306_t *p) {
+    if(p->clip_x0>p->clip_x1||p->clip_y0>p->clip_y1)
+        return;
+
+    if(p->clip_x0==0&&p->clip_y0==0&&p->clip_x1==SSD1306_W(p)-1&&p->clip_y1==SSD1306_H(p)-1) {
+        memset(p->buffer, 0, p->bufsize);
+        ssd1306_mark_dirty(p, 0, SSD1306_W(p)-1, 0, SSD1306_PAGES(p)-1);
+        return;
+    }
+
+    ssd1306_fill_buffer_rect(p, p->clip_x0, p->clip_y0, p->clip_x1+1, p->clip_y1+1, SSD1306_DRAW_CLEAR);
+}
+
+/**
+	@brief clear pixel on buffer
+
+	@param p : instance of display
+	@param x : x position
+	@param y : y position
+*/
+void ssd1306_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
+    p->clear_pixel_fn(p, x, y);
+}
+
+/**
+	@brief reset display
+
+	@param p : instance of display
+*/
+void ssd1306_reset(ssd1306_t *p) {
+    uint8_t payload[] = {
+        SET_DISP,
+        SET_ENTIRE_ON,
+        SET_DISP_CLK_DIV,
+        0x80,
+        SET_CHARGE_PUMP,
+        0x14,
+        SET_NORM_INV,
+        SET_DISP_OFFSET,
+        0x00,
+        SET_DISP_START_LINE,
+        SET_DISP_ON
+    };
+
+    ssd1306_write_cmds(p, payload, sizeof(payload));
+    p->start_line=0;
+}
+
+/**
+	@brief draw pixel on buffer
+
+	@param p : instance of display
+	@param x : x position
+	@param y : y position
+*/
+void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
+    p->draw_pixel_fn(p, x, y);
+}
+
+/**
+	@brief draw line on buffer
+
+	@param p : instance of display
+	@param x1 : x position of starting point
+	@param y1 : y position of starting point
+	@param x2 : x position of end point
+	@param y2 : y position of end point
+*/
+void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if(y1==y2) { // horizontal: one bit mask across a page row
+        if(x1>x2)
+            swap(&x1, &x2);
+        ssd1306_hspan(p, x1, x2, y1, p->mode);
+        return;
+    }
+
+    if(x1==x2) { // vertical: page masked column
+        if(y1>y2)
+            swap(&y1, &y2);
+        if(x1<0||y2<0)
+            return;
+        if(y1<0)
+            y1=0;
+        ssd1306_fill_rect(p, x1, y1, 1, y2-y1+1, p->mode);
+        return;
+    }
+
+    const ssd1306_pixel_fn_t px=p->draw_pixel_fn;
+    const int32_t dx=x2>x1?x2-x1:x1-x2, sx=x1<x2?1:-1;
+    const int32_t dy=y2>y1?y1-y2:y2-y1, sy=y1<y2?1:-1;
+
+    for(int32_t err=dx+dy;;) {
+        px(p, x1, y1); // negative coordinates wrap around and get clipped
+        if(x1==x2&&y1==y2)
+            break;
+
+        int32_t e2=2*err;
+        if(e2>=dy) {
+            err+=dy;
+            x1+=sx;
+        }
+        if(e2<=dx) {
+            err+=dx;
+            y1+=sy;
+        }
+    }
+}
+
+/**
+	@brief clear square at given position with given size
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+*/
+void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    ssd1306_fill_rect(p, x, y, width, height, SSD1306_DRAW_CLEAR);
+}
+
+/**
+	@brief draw filled square at given position with given size
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+*/
+void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    ssd1306_fill_rect(p, x, y, width, height, p->mode);
+}
+
+/**
+	@brief invert square at given position with given size
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+*/
+void ssd1306_invert_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    ssd1306_fill_rect(p, x, y, width, height, SSD1306_DRAW_XOR);
+}
+
+/**
+	@brief draw empty square at given position with given size
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+*/
+void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
+    ssd1306_fill_rect(p, x, y, width+1, 1, p->mode);
+    if(height>0)
+        ssd1306_fill_rect(p, x, y+height, width+1, 1, p->mode);
+    if(height>1) {
+        ssd1306_fill_rect(p, x, y+1, 1, height-1, p->mode);
+        if(width>0)
+            ssd1306_fill_rect(p, x+width, y+1, 1, height-1, p->mode);
+    }
+}
+
+/**
+ * @brief quadrants of ssd1306_circle_outline, y pointing down
+ */
+#define SSD1306_QUADRANT_UR 0x01
+#define SSD1306_QUADRANT_UL 0x02
+#define SSD1306_QUADRANT_LL 0x04
+#define SSD1306_QUADRANT_LR 0x08
+#define SSD1306_QUADRANT_AXES 0x10
+#define SSD1306_QUADRANT_ALL 0x1F
+
+/**
+ * @brief sin(0°..90°) scaled by 1024
+ */
+static const int16_t ssd1306_sin_table[91]= {
+    0, 18, 36, 54, 71, 89, 107, 125, 143, 160,
+    178, 195, 213, 230, 248, 265, 282, 299, 316, 333,
+    350, 367, 384, 400, 416, 433, 449, 465, 481, 496,
+    512, 527, 543, 558, 573, 587, 602, 616, 630, 644,
+    658, 672, 685, 698, 711, 724, 737, 749, 761, 773,
+    784, 796, 807, 818, 828, 839, 849, 859, 868, 878,
+    887, 896, 904, 912, 920, 928, 935, 943, 949, 956,
+    962, 968, 974, 979, 984, 989, 994, 998, 1002, 1005,
+    1008, 1011, 1014, 1016, 1018, 1020, 1022, 1023, 1023, 1024,
+    1024
+};
+
+/**
+ * @brief sine of an angle in degrees, scaled by 1024
+ *
+ * @param deg : angle in degrees (0-359)
+ */
+static int32_t ssd1306_sin(uint32_t deg) {
+    if(deg<=90)
+        return ssd1306_sin_table[deg];
+    if(deg<=180)
+        return ssd1306_sin_table[180-deg];
+    if(deg<=270)
+        return -ssd1306_sin_table[deg-180];
+    return -ssd1306_sin_table[360-deg];
+}
+
+/**
+ * @brief angular range of an arc as start and end vectors (y pointing up)
+ */
+typedef struct {
+    int32_t sx, sy;	/**< start vector */
+    int32_t ex, ey;	/**< end vector */
+    bool wide;	/**< range is wider than 180° */
+} ssd1306_arc_range_t;
+
+/**
+ * @brief check whether a point lies inside of an arc range
+ *
+ * @param a : arc range
+ * @param x : x offset from the center
+ * @param y : y offset from the center, pointing up
+ */
+inline static bool ssd1306_in_arc(const ssd1306_arc_range_t *a, int32_t x, int32_t y) {
+    const int32_t after_start=a->sx*y-a->sy*x, before_end=x*a->ey-y*a->ex;
+
+    if(a->wide)
+        return !(before_end<0&&after_start<0);
+    return after_start>=0&&before_end>=0;
+}
+
+/**
+ * @brief plot one point of a circle outline if it lies in the selected parts
+ *
+ * @param p : instance of display
+ * @param px : pixel kernel
+ * @param cx : x position of the center
+ * @param cy : y position of the center
+ * @param dx : x offset from the center
+ * @param dy : y offset from the center
+ * @param parts : SSD1306_QUADRANT_* bits to draw
+ * @param arc : arc range to restrict to, NULL to draw the whole parts
+ */
+inline static void ssd1306_circle_point(ssd1306_t *p, ssd1306_pixel_fn_t px, int32_t cx, int32_t cy, int32_t dx, int32_t dy, uint8_t parts, const ssd1306_arc_range_t *arc) {
+    uint8_t part;
+    if(dx==0||dy==0)
+        part=SSD1306_QUADRANT_AXES;
+    else if(dy<0)
+        part=dx>0?SSD1306_QUADRANT_UR:SSD1306_QUADRANT_UL;
+    else
+        part=dx>0?SSD1306_QUADRANT_LR:SSD1306_QUADRANT_LL;
+
+    if(!(parts&part)||(arc&&!ssd1306_in_arc(arc, dx, -dy)))
+        return;
+
+    px(p, cx+dx, cy+dy); // negative coordinates wrap around and get clipped
+}
+
+/**
+ * @brief draw a circle outline with the midpoint algorithm
+ *
+ * Every pixel is plotted exactly once.
+ *
+ * @param p : instance of display
+ * @param px : pixel kernel
+ * @param cx : x position of the center
+ * @param cy : y position of the center
+ * @param r : radius
+ * @param parts : SSD1306_QUADRANT_* bits to draw
+ * @param arc : arc range to restrict to, NULL to draw the whole parts
+ */
+static void ssd1306_circle_outline(ssd1306_t *p, ssd1306_pixel_fn_t px, int32_t cx, int32_t cy, int32_t r, uint8_t parts, const ssd1306_arc_range_t *arc) {
+    if(r<0)
+        return;
+    if(r==0) {
+        ssd1306_circle_point(p, px, cx, cy, 0, 0, parts, arc);
+        return;
+    }
+
+    for(int32_t x=r, y=0, err=1-r; x>=y;) {
+        if(y==0) {
+            ssd1306_circle_point(p, px, cx, cy, x, 0, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, -x, 0, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, 0, x, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, 0, -x, parts, arc);
+        } else {
+            ssd1306_circle_point(p, px, cx, cy, x, y, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, -x, y, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, x, -y, parts, arc);
+            ssd1306_circle_point(p, px, cx, cy, -x, -y, parts, arc);
+            if(x!=y) {
+                ssd1306_circle_point(p, px, cx, cy, y, x, parts, arc);
+                ssd1306_circle_point(p, px, cx, cy, -y, x, parts, arc);
+                ssd1306_circle_point(p, px, cx, cy, y, -x, parts, arc);
+                ssd1306_circle_point(p, px, cx, cy, -y, -x, parts, arc);
+            }
+        }
+
+        ++y;
+        if(err<0) {
+            err+=2*y+1;
+        } else {
+            --x;
+            err+=2*(y-x)+1;
+        }
+    }
+}
+
+/**
+ * @brief fill a rounded area with horizontal spans
+ *
+ * Fills the rows cy0..cy1 from cx0-n to cx1+n, and above and below them
+ * the rows of circles of radius r centered at the four corners, limited
+ * to n pixels from the centers. Every pixel is written exactly once.
+ *
+ * @param p : instance of display
+ * @param cx0 : x position of the left centers
+ * @param cx1 : x position of the right centers
+ * @param cy0 : y position of the upper centers
+ * @param cy1 : y position of the lower centers
+ * @param r : radius
+ * @param n : maximum distance from the centers
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_fill_round(ssd1306_t *p, int32_t cx0, int32_t cx1, int32_t cy0, int32_t cy1, int32_t r, int32_t n, uint8_t mode) {
+    for(int32_t y=cy0; y<=cy1; ++y)
+        ssd1306_hspan(p, cx0-n, cx1+n, y, mode);
+
+    for(int32_t dy=1, half=n; dy<=n; ++dy) {
+        while(half>0&&half*half+dy*dy>r*r)
+            --half;
+        ssd1306_hspan(p, cx0-half, cx1+half, cy0-dy, mode);
+        ssd1306_hspan(p, cx0-half, cx1+half, cy1+dy, mode);
+    }
+}
+
+/**
+	@brief clear filled circle at given position with given radius
+
+	@param p : instance of display
+	@param x : x position of the center of the circle
+	@param y : y position of the center of the circle
+	@param r : radius of the circle
+*/
+void ssd1306_clear_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
+    if(r>0)
+        ssd1306_fill_round(p, x, x, y, y, r, r-1, SSD1306_DRAW_CLEAR);
+}
+
+/**
+	@brief draw filled circle at given position with given radius
+
+	@param p : instance of display
+	@param x : x position of the center of the circle
+	@param y : y position of the center of the circle
+	@param r : radius of the circle
+*/
+void ssd1306_draw_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
+    if(r>0)
+        ssd1306_fill_round(p, x, x, y, y, r, r-1, p->mode);
+}
+
+/**
+	@brief draw empty circle at given position with given radius
+
+	@param p : instance of display
+	@param x : x position of the center of the circle
+	@param y : y position of the center of the circle
+	@param r : radius of the circle
+*/
+void ssd1306_draw_empty_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
+    if(r>0)
+        ssd1306_circle_outline(p, p->draw_pixel_fn, x, y, r-1, SSD1306_QUADRANT_ALL, NULL);
+}
+
+/**
+	@brief draw arc of a circle
+
+	@param p : instance of display
+	@param x : x position of the center of the circle
+	@param y : y position of the center of the circle
+	@param r : radius of the circle
+	@param start : start angle in degrees
+	@param end : end angle in degrees
+*/
+void ssd1306_draw_arc(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r, uint32_t start, uint32_t end) {
+    if(r==0)
+        return;
+
+    start%=360;
+    end%=360;
+
+    ssd1306_arc_range_t arc= {
+        .sx=ssd1306_sin((start+90)%360),
+        .sy=ssd1306_sin(start),
+        .ex=ssd1306_sin((end+90)%360),
+        .ey=ssd1306_sin(end),
+        .wide=(end+360-start)%360>180||start==end,
+    };
+
+    ssd1306_circle_outline(p, p->draw_pixel_fn, x, y, r-1, SSD1306_QUADRANT_ALL, &arc);
+}
+
+/**
+ * @brief limit the corner radius of a rounded square to its size
+ *
+ * @param r : requested radius
+ * @param width : width of square
+ * @param height : height of square
+ */
+inline static uint32_t ssd1306_round_radius(uint32_t r, uint32_t width, uint32_t height) {
+    if(2*r>=width)
+        r=(width-1)/2;
+    if(2*r>=height)
+        r=(height-1)/2;
+    return r;
+}
+
+/**
+	@brief draw filled square with rounded corners
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+	@param r : radius of the corners
+*/
+void ssd1306_draw_round_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t r) {
+    if(width==0||height==0)
+        return;
+
+    r=ssd1306_round_radius(r, width, height);
+    ssd1306_fill_round(p, x+r, x+width-1-r, y+r, y+height-1-r, r, r, p->mode);
+}
+
+/**
+	@brief draw empty square with rounded corners
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+	@param r : radius of the corners
+*/
+void ssd1306_draw_empty_round_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t r) {
+    if(width==0||height==0)
+        return;
+
+    r=ssd1306_round_radius(r, width, height);
+    const int32_t x0=x+r, x1=x+width-1-r, y0=y+r, y1=y+height-1-r;
+    const ssd1306_pixel_fn_t px=p->draw_pixel_fn;
+
+    ssd1306_hspan(p, x0, x1, y, p->mode);
+    if(height>1)
+        ssd1306_hspan(p, x0, x1, y+height-1, p->mode);
+    if(height>2) {
+        ssd1306_fill_rect(p, x, y0+(r==0), 1, y1-y0+1-2*(r==0), p->mode);
+        if(width>1)
+            ssd1306_fill_rect(p, x+width-1, y0+(r==0), 1, y1-y0+1-2*(r==0), p->mode);
+    }
+
+    ssd1306_circle_outline(p, px, x1, y0, r, SSD1306_QUADRANT_UR, NULL);
+    ssd1306_circle_outline(p, px, x0, y0, r, SSD1306_QUADRANT_UL, NULL);
+    ssd1306_circle_outline(p, px, x0, y1, r, SSD1306_QUADRANT_LL, NULL);
+    ssd1306_circle_outline(p, px, x1, y1, r, SSD1306_QUADRANT_LR, NULL);
+}
+
+/**
+ * @brief OR or AND-NOT one glyph column byte into the buffer
+ *
+ * @param p : instance of display
+ * @param col : column in buffer
+ * @param y : row in buffer of bit 0 of the byte
+ * @param b : glyph bits, bit 0 on top
+ * @param mode : SSD1306_DRAW_* operation
+ */
+inline static void ssd1306_merge_column(ssd1306_t *p, uint32_t col, uint32_t y, uint8_t b, uint8_t mode) {
+    const uint32_t page=y>>3, shift=y&7;
+    uint8_t *dst=p->buffer+page*SSD1306_W(p)+col;
+
+    // pages outside the clip rectangle are not touched at all, see ssd1306_list_show
+    if(page<SSD1306_PAGES(p)&&ssd1306_clip_mask(p, page))
+        ssd1306_span(dst, 1, (b<<shift)&ssd1306_clip_mask(p, page), mode);
+
+    if(shift&&page+1<SSD1306_PAGES(p)&&ssd1306_clip_mask(p, page+1))
+        ssd1306_span(dst+SSD1306_W(p), 1, (b>>(8-shift))&ssd1306_clip_mask(p, page+1), mode);
+}
+
+/**
+ * @brief get the bytes per column of a fixed width or proportional font
+ *
+ * @param font : pointer to font
+ * @return bytes per column
+ */
+inline static uint32_t ssd1306_font_pages(const uint8_t *font) {
+    const uint8_t height=font[0]?font[0]:font[2];
+    return (height>>3)+((height&7)>0);
+}
+
+/**
+ * @brief look up the columns of a char
+ *
+ * Fixed width fonts compute the position from the char, proportional fonts
+ * read it from their offsets, so both take constant time.
+ *
+ * @param font : pointer to font
+ * @param c : character
+ * @param width : set to the columns of the char
+ * @param advance : set to the distance to the next char
+ * @return columns of the char, NULL if the font does not have it or is a proportional font of another version
+ */
+inline static const uint8_t *ssd1306_font_glyph(const uint8_t *font, char c, uint32_t *width, uint32_t *advance) {
+    if(font[0]) {
+        *width=font[1];
+        *advance=font[1]+font[2];
+        if(c<font[3]||c>font[4])
+            return NULL;
+        return font+5+(c-font[3])*font[1]*ssd1306_font_pages(font);
+    }
+
+    *width=*advance=0;
+    // later versions may lay out the offsets differently
+    if(font[1]!=SSD1306_FONT_V1||c<font[4]||c>font[5])
+        return NULL;
+
+    const uint32_t pages=ssd1306_font_pages(font), chars=font[5]-font[4]+1;
+    const uint8_t *offset=font+6+2*(c-font[4]);
+    const uint32_t start=offset[0]|offset[1]<<8, end=offset[2]|offset[3]<<8;
+    *width=pages==1?end-start:(end-start)/pages;
+    *advance=*width+font[3];
+
+    return font+6+2*(chars+1)+start;
+}
+
+/**
+	@brief initialize an empty glyph cache
+
+	@param cache : instance of cache
+	@param pool : memory for the bitmaps, kept by the cache
+	@param size : size of pool in bytes
+
+*/
+void ssd1306_glyph_cache_init(ssd1306_glyph_cache_t *cache, uint8_t *pool, size_t size) {
+    cache->pool=pool;
+    cache->size=size;
+    cache->used=0;
+    cache->n=0;
+    cache->clock=0;
+    cache->hits=0;
+    cache->misses=0;
+}
+
+/**
+	@brief draw scaled text through a glyph cache
+
+	@param p : instance of display
+	@param cache : cache to use, NULL to stop using one
+
+*/
+inline void ssd1306_set_glyph_cache(ssd1306_t *p, ssd1306_glyph_cache_t *cache) {
+    p->glyph_cache=cache;
+}
+
+/**
+ * @brief remove a glyph from a cache, moving the bitmaps behind it down
+ *
+ * @param cache : instance of cache
+ * @param i : entry of the glyph
+ */
+static void ssd1306_glyph_cache_evict(ssd1306_glyph_cache_t *cache, uint32_t i) {
+    const ssd1306_glyph_entry_t e=cache->entries[i];
+
+    memmove(cache->pool+e.offset, cache->pool+e.offset+e.size, cache->used-e.offset-e.size);
+    cache->used-=e.size;
+
+    memmove(cache->entries+i, cache->entries+i+1, (cache->n-i-1)*sizeof(*cache->entries));
+    --(cache->n);
+    for(uint32_t k=i; k<cache->n; ++k)
+        cache->entries[k].offset-=e.size;
+}
+
+/**
+ * @brief get a scaled glyph from a cache, scaling it on a miss
+ *
+ * The bitmap is in page format: pages of glyph_width*scale bytes, top
+ * pixel in bit 0.
+ *
+ * @param cache : instance of cache
+ * @param glyph : unscaled glyph in the font
+ * @param glyph_width : columns of the glyph
+ * @param font : font of the glyph
+ * @param c : character
+ * @param scale : scale, at most 255
+ * @return bitmap, NULL if it does not fit into the pool
+ */
+static const uint8_t *ssd1306_glyph_cache_get(ssd1306_glyph_cache_t *cache, const uint8_t *glyph, uint32_t glyph_width, const uint8_t *font, char c, uint32_t scale) {
+    const uint32_t parts_per_line=ssd1306_font_pages(font), pages=parts_per_line*scale;
+    const size_t size=glyph_width*scale*pages;
+
+    ++(cache->clock);
+    for(uint32_t i=0; i<cache->n; ++i) {
+        ssd1306_glyph_entry_t *e=cache->entries+i;
+        if(e->font==font&&e->c==(uint8_t) c&&e->scale==scale) {
+            e->used=cache->clock;
+            ++(cache->hits);
+            return cache->pool+e->offset;
+        }
+    }
+
+    ++(cache->misses);
+    if(size>cache->size||size>UINT16_MAX)
+        return NULL;
+
+    while(cache->n==SSD1306_GLYPH_CACHE_MAX||cache->size-cache->used<size) {
+        uint32_t lru=0;
+        for(uint32_t i=1; i<cache->n; ++i)
+            if(cache->clock-cache->entries[i].used>cache->clock-cache->entries[lru].used)
+                lru=i;
+        ssd1306_glyph_cache_evict(cache, lru);
+    }
+
+    uint8_t *bitmap=cache->pool+cache->used;
+    const uint32_t width=glyph_width*scale;
+    memset(bitmap, 0, size);
+    for(uint32_t w=0; w<glyph_width; ++w, glyph+=parts_per_line) {
+        uint8_t *column=bitmap+w*scale;
+        for(uint32_t j=0; j<(parts_per_line<<3); ++j) {
+            if(!(glyph[j>>3]>>(j&7)&1))
+                continue;
+            for(uint32_t r=j*scale; r<(j+1)*scale; ++r)
+                column[(r>>3)*width]|=1<<(r&7);
+        }
+        for(uint32_t lp=0; lp<pages; ++lp)
+            memset(column+lp*width+1, column[lp*width], scale-1);
+    }
+
+    cache->entries[cache->n++]=(ssd1306_glyph_entry_t) {
+        .font=font,
+        .c=c,
+        .scale=scale,
+        .size=size,
+        .offset=cache->used,
+        .used=cache->clock,
+    };
+    cache->used+=size;
+
+    return bitmap;
+}
+
+/**
+ * @brief draw a glyph bitmap of page bytes at rotation 0
+ *
+ * Byte lp of column w is at bitmap[w*col_stride+lp*page_stride], so both
+ * the column major glyphs of fonts and page format bitmaps can be drawn.
+ *
+ * @param p : instance of display
+ * @param x : x position of the glyph
+ * @param y : y position of the glyph
+ * @param bitmap : glyph, top pixel of each byte in bit 0
+ * @param width : columns of the glyph
+ * @param pages : bytes per column
+ * @param col_stride : distance of columns in bitmap
+ * @param page_stride : distance of pages in bitmap
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_glyph_bitmap(ssd1306_t *p, int32_t x, int32_t y, const uint8_t *bitmap, uint32_t width, uint32_t pages, uint32_t col_stride, uint32_t page_stride, uint8_t mode) {
+    const int32_t first=x<p->clip_x0?p->clip_x0-x:0;
+    const int32_t last=p->clip_x1+1-x<(int32_t) width?p->clip_x1+1-x:(int32_t) width;
+    const int32_t y0=y>p->clip_y0?y:p->clip_y0;
+    const int32_t y1=y+(int32_t) (pages<<3)-1<p->clip_y1?y+(int32_t) (pages<<3)-1:p->clip_y1;
+    if(first>=last||y0>y1)
+        return;
+
+    const uint32_t shift=y&7, w=SSD1306_W(p);
+    for(uint32_t lp=(y0-y)>>3; lp<pages&&y+(int32_t) (lp<<3)<=y1; ++lp) {
+        const int32_t page=(y>>3)+(int32_t) lp; // arithmetic shift, the part above page 0 is clipped
+        const uint8_t lo=page>=0?ssd1306_clip_mask(p, page):0, hi=shift?ssd1306_clip_mask(p, page+1):0;
+        const uint8_t *src=bitmap+first*col_stride+lp*page_stride;
+        uint8_t *dst=p->buffer+page*(int32_t) w+x+first;
+
+        switch(mode) {
+        case SSD1306_DRAW_SET:
+            for(int32_t i=first; i<last; ++i, src+=col_stride, ++dst) {
+                if(lo)
+                    *dst|=(*src<<shift)&lo;
+                if(hi)
+                    dst[w]|=(*src>>(8-shift))&hi;
+            }
+            break;
+        case SSD1306_DRAW_CLEAR:
+            for(int32_t i=first; i<last; ++i, src+=col_stride, ++dst) {
+                if(lo)
+                    *dst&=~((*src<<shift)&lo);
+                if(hi)
+                    dst[w]&=~((*src>>(8-shift))&hi);
+            }
+            break;
+        default:
+            for(int32_t i=first; i<last; ++i, src+=col_stride, ++dst) {
+                if(lo)
+                    *dst^=(*src<<shift)&lo;
+                if(hi)
+                    dst[w]^=(*src>>(8-shift))&hi;
+            }
+            break;
+        }
+    }
+
+    ssd1306_mark_dirty(p, x+first, x+last-1, y0>>3, y1>>3);
+}
+
+/**
+ * @brief draw or clear a glyph
+ *
+ * Unscaled glyphs at rotation 0 are merged into the buffer a column byte
+ * at a time (shifted across two pages if y is not page aligned), all
+ * other glyphs are drawn as runs of set bits with the fill kernel.
+ *
+ * @param p : instance of display
+ * @param x : x starting position of char
+ * @param y : y starting position of char
+ * @param scale : scale font to n times of original size
+ * @param font : pointer to font
+ * @param c : character to draw
+ * @param glyph : columns of the char from ssd1306_font_glyph
+ * @param width : number of columns
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_glyph_columns(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c, const uint8_t *glyph, uint32_t width, uint8_t mode) {
+    const uint32_t parts_per_line=ssd1306_font_pages(font);
+
+    if(scale==1&&p->rotation==0) {
+        ssd1306_glyph_bitmap(p, x, y, glyph, width, parts_per_line, parts_per_line, 1, mode);
+        return;
+    }
+
+    if(p->glyph_cache&&p->rotation==0&&scale<=UINT8_MAX) {
+        const uint8_t *scaled=ssd1306_glyph_cache_get(p->glyph_cache, glyph, width, font, c, scale);
+        if(scaled) {
+            ssd1306_glyph_bitmap(p, x, y, scaled, width*scale, parts_per_line*scale, 1, width*scale, mode);
+            return;
+        }
+    }
+
+    for(uint32_t w=0; w<width; ++w, glyph+=parts_per_line) {
+        uint32_t run=0;
+        for(uint32_t j=0; j<(parts_per_line<<3); ++j) {
+            if(glyph[j>>3]>>(j&7)&1) {
+                ++run;
+                continue;
+            }
+            if(run)
+                ssd1306_fill_rect(p, x+w*scale, y+(j-run)*scale, scale, run*scale, mode);
+            run=0;
+        }
+        if(run)
+            ssd1306_fill_rect(p, x+w*scale, y+((parts_per_line<<3)-run)*scale, scale, run*scale, mode);
+    }
+}
+
+static void ssd1306_glyph(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c, uint8_t mode) {
+    uint32_t width, advance;
+    const uint8_t *glyph=ssd1306_font_glyph(font, c, &width, &advance);
+
+    if(glyph&&width)
+        ssd1306_glyph_columns(p, x, y, scale, font, c, glyph, width, mode);
+}
+
+/**
+	@brief clear char with given font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param c : character to clear
+*/
+void ssd1306_clear_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
+    ssd1306_glyph(p, x, y, scale, font, c, SSD1306_DRAW_CLEAR);
+}
+
+/**
+	@brief draw char with given font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param c : character to draw
+*/
+void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
+    ssd1306_glyph(p, x, y, scale, font, c, p->mode);
+}
+
+/**
+ * @brief draw or clear at most n chars of a string
+ *
+ * Chars left of the clip rectangle are skipped without being looked at,
+ * drawing stops at the first char right of it.
+ *
+ * @param p : instance of display
+ * @param x : x starting position of text
+ * @param y : y starting position of text
+ * @param scale : scale font to n times of original size
+ * @param font : pointer to font
+ * @param s : text to draw
+ * @param n : maximum number of chars
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_text(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s, size_t n, uint8_t mode) {
+    int32_t cx0, cy0, cx1, cy1;
+    ssd1306_get_clip(p, &cx0, &cy0, &cx1, &cy1);
+
+    const int64_t height=(ssd1306_font_pages(font)<<3)*scale;
+    int64_t x_n=(int32_t) x;
+
+    if((int64_t) (int32_t) y>cy1||(int64_t) (int32_t) y+height<=cy0)
+        return;
+
+    if(font[0]==0) {
+        // proportional: chars left of the clip rectangle only have their offsets read
+        for(; n&&*s&&x_n<=cx1; --n, ++s) {
+            uint32_t w, a;
+            const uint8_t *glyph=ssd1306_font_glyph(font, *s, &w, &a);
+            if(glyph&&w&&x_n+w*scale>cx0)
+                ssd1306_glyph_columns(p, x_n, y, scale, font, *s, glyph, w, mode);
+            x_n+=a*scale;
+        }
+        return;
+    }
+
+    const int64_t advance=(font[1]+font[2])*scale, width=font[1]*scale;
+    if(advance==0)
+        return;
+
+    if(x_n+width<=cx0) {
+        size_t skip=(cx0-(x_n+width))/advance+1;
+        const char *end=memchr(s, 0, skip<n?skip:n);
+        if(end) // string ends before the clip rectangle
+            return;
+        if(skip>=n)
+            return;
+        s+=skip;
+        n-=skip;
+        x_n+=skip*advance;
+    }
+
+    for(; n&&*s&&x_n<=cx1; --n, x_n+=advance)
+        ssd1306_glyph(p, x_n, y, scale, font, *(s++), mode);
+}
+
+/**
+	@brief clear string with given font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param s : text to clear
+*/
+void ssd1306_clear_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
+    ssd1306_text(p, x, y, scale, font, s, SIZE_MAX, SSD1306_DRAW_CLEAR);
+}
+
+/**
+	@brief draw string with given font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param s : text to draw
+*/
+void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
+    ssd1306_text(p, x, y, scale, font, s, SIZE_MAX, p->mode);
+}
+
+/**
+	@brief draw at most n chars of a string with given font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param s : text to draw
+	@param n : maximum number of chars to draw
+*/
+void ssd1306_draw_text_n(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s, size_t n) {
+    ssd1306_text(p, x, y, scale, font, s, n, p->mode);
+}
+
+/**
+	@brief get width of at most n chars of a string
+
+	@param font : pointer to font
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to measure
+	@param n : maximum number of chars
+	@return width in pixels
+*/
+uint32_t ssd1306_text_width_n(const uint8_t *font, uint32_t scale, const char *s, size_t n) {
+    size_t len=0;
+
+    if(font[0]==0) {
+        uint32_t width=0, spacing=0, w, a;
+        for(; len<n&&s[len]; ++len) {
+            if(ssd1306_font_glyph(font, s[len], &w, &a)) {
+                width+=a;
+                spacing=a-w;
+            }
+        }
+        // the last char ends after its columns, not after its spacing
+        return (width-spacing)*scale;
+    }
+
+    while(len<n&&s[len])
+        ++len;
+
+    return len?(len*(font[1]+font[2])-font[2])*scale:0;
+}
+
+/**
+	@brief get width of a string
+
+	@param font : pointer to font
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to measure
+	@return width in pixels
+*/
+uint32_t ssd1306_text_width(const uint8_t *font, uint32_t scale, const char *s) {
+    return ssd1306_text_width_n(font, scale, s, SIZE_MAX);
+}
+
+/**
+	@brief clear char with builtin font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param c : character to clear
+*/
+void ssd1306_clear_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
+    ssd1306_clear_char_with_font(p, x, y, scale, font_8x5, c);
+}
+
+/**
+	@brief draw char with builtin font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param c : character to draw
+*/
+void ssd1306_draw_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
+    ssd1306_draw_char_with_font(p, x, y, scale, font_8x5, c);
+}
+
+/**
+	@brief clear string with builtin font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to clear
+*/
+void ssd1306_clear_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s) {
+    ssd1306_clear_string_with_font(p, x, y, scale, font_8x5, s);
+}
+
+/**
+	@brief draw string with builtin font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to draw
+*/
+void ssd1306_draw_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s) {
+    ssd1306_draw_string_with_font(p, x, y, scale, font_8x5, s);
+}
+
+/**
+ * @brief retrieve a value from a BMP image header.
+ *
+ * @param data : pointer to the BMP image data.
+ * @param offset : offset of the value in the header.
+ * @param size : size of the value (1, 2, or 4 bytes).
+ * @return : the retrieved value.
+ */
+static inline uint32_t ssd1306_bmp_get_val(const uint8_t *data, const size_t offset, uint8_t size) {
+    switch(size) {
+    case 1:
+        return data[offset];
+    case 2:
+        return data[offset]|(data[offset+1]<<8);
+    case 4:
+        return data[offset]|(data[offset+1]<<8)|(data[offset+2]<<16)|(data[offset+3]<<24);
+    default:
+        __builtin_unreachable();
+    }
+    __builtin_unreachable();
+}
+
+/**
+ * @brief transpose 8 rows of 8 pixels into 8 columns
+ *
+ * @param rows : rows from top to bottom, leftmost pixel in bit 7
+ * @param columns : columns from left to right, top pixel in bit 0
+ */
+static void ssd1306_transpose8(const uint8_t *rows, uint8_t *columns) {
+    // Hacker's Delight transpose8, fed bottom row first to put the top row into bit 0
+    uint32_t x=(rows[7]<<24)|(rows[6]<<16)|(rows[5]<<8)|rows[4];
+    uint32_t y=(rows[3]<<24)|(rows[2]<<16)|(rows[1]<<8)|rows[0];
+    uint32_t t;
+
+    t=(x^(x>>7))&0x00AA00AA;
+    x=x^t^(t<<7);
+    t=(y^(y>>7))&0x00AA00AA;
+    y=y^t^(t<<7);
+    t=(x^(x>>14))&0x0000CCCC;
+    x=x^t^(t<<14);
+    t=(y^(y>>14))&0x0000CCCC;
+    y=y^t^(t<<14);
+    t=(x&0xF0F0F0F0)|((y>>4)&0x0F0F0F0F);
+    y=((x<<4)&0xF0F0F0F0)|(y&0x0F0F0F0F);
+    x=t;
+
+    columns[0]=x>>24;
+    columns[1]=x>>16;
+    columns[2]=x>>8;
+    columns[3]=x;
+    columns[4]=y>>24;
+    columns[5]=y>>16;
+    columns[6]=y>>8;
+    columns[7]=y;
+}
+
+/**
+ * @brief draw the pixels of a monochrome bitmap at rotation 0
+ *
+ * Converts 8 rows at a time into page bytes and merges them into the buffer.
+ *
+ * @param p : instance of display
+ * @param img_data : first stored row
+ * @param width : width of image
+ * @param height : height of image, negative for images stored top-down
+ * @param bytes_per_line : size of a stored row
+ * @param color_val : value of the bits to draw
+ * @param x_offset : offset of horizontal coordinate
+ * @param y_offset : offset of vertical coordinate
+ */
+static void ssd1306_bmp_blit(ssd1306_t *p, const uint8_t *img_data, uint32_t width, int32_t height, uint32_t bytes_per_line, uint8_t color_val, uint32_t x_offset, uint32_t y_offset) {
+    const int32_t rows=height>0?height:-height;
+    const int32_t x0=(int32_t) x_offset, y0=(int32_t) y_offset;
+    const uint8_t inv=color_val?0x00:0xFF;
+
+    if(x0>p->clip_x1||y0>p->clip_y1||x0+(int32_t) width<=p->clip_x0||y0+rows<=p->clip_y0)
+        return;
+
+    for(int32_t t0=0; t0<rows; t0+=8) {
+        int32_t y=y0+t0;
+        if(y<=-8)
+            continue;
+        if(y>p->clip_y1)
+            break;
+
+        const uint8_t *line[8];
+        for(int32_t i=0; i<8; ++i) {
+            const int32_t t=t0+i;
+            line[i]=t>=rows?NULL:img_data+(height>0?rows-1-t:t)*bytes_per_line;
+        }
+
+        for(uint32_t k=0; k<(width+7)/8; ++k) {
+            const int32_t col=x0+(int32_t) (k<<3);
+            if(col>p->clip_x1)
+                break;
+            if(col+8<=p->clip_x0)
+                continue;
+
+            uint8_t bits[8], columns[8];
+            for(int32_t i=0; i<8; ++i)
+                bits[i]=line[i]?line[i][k]^inv:0;
+            ssd1306_transpose8(bits, columns);
+
+            for(uint32_t j=0; j<8&&(k<<3)+j<width; ++j) {
+                const int32_t cx=col+j;
+                if(cx<p->clip_x0||!columns[j])
+                    continue;
+                if(cx>p->clip_x1)
+                    break;
+                if(y<0)
+                    ssd1306_merge_column(p, cx, 0, columns[j]>>-y, p->mode);
+                else
+                    ssd1306_merge_column(p, cx, y, columns[j], p->mode);
+            }
+        }
+    }
+
+    const int32_t dx0=x0>p->clip_x0?x0:p->clip_x0, dy0=y0>p->clip_y0?y0:p->clip_y0;
+    const int32_t dx1=x0+(int32_t) width-1<p->clip_x1?x0+(int32_t) width-1:p->clip_x1;
+    const int32_t dy1=y0+rows-1<p->clip_y1?y0+rows-1:p->clip_y1;
+    ssd1306_mark_dirty(p, dx0, dx1, dy0>>3, dy1>>3);
+}
+
+/**
+ * @brief apply a raster operation to a buffer byte
+ *
+ * @param dst : buffer byte
+ * @param s : sprite bits
+ * @param m : bits to change
+ * @param rop : raster operation
+ */
+inline static void ssd1306_rop_byte(uint8_t *dst, uint8_t s, uint8_t m, ssd1306_rop_t rop) {
+    switch(rop) {
+    case SSD1306_ROP_OR:
+        *dst|=s&m;
+        break;
+    case SSD1306_ROP_AND:
+        *dst&=s|~m;
+        break;
+    case SSD1306_ROP_XOR:
+        *dst^=s&m;
+        break;
+    case SSD1306_ROP_COPY:
+        *dst=(*dst&~m)|(s&m);
+        break;
+    }
+}
+
+/**
+ * @brief transform display coordinates into buffer coordinates
+ *
+ * @param p : instance of display
+ * @param x : x position
+ * @param y : y position
+ * @param bx : column in buffer
+ * @param by : row in buffer
+ */
+inline static void ssd1306_buffer_pos(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t *bx, uint32_t *by) {
+    switch(p->rotation) {
+    case 0:
+        *bx=x, *by=y;
+        break;
+    case 1:
+        *bx=SSD1306_W(p)-1-y, *by=x;
+        break;
+    case 2:
+        *bx=SSD1306_W(p)-1-x, *by=SSD1306_H(p)-1-y;
+        break;
+    default:
+        *bx=y, *by=SSD1306_H(p)-1-x;
+        break;
+    }
+}
+
+/**
+ * @brief blit a sprite pixel by pixel, for rotations other than 0
+ *
+ * @param p : instance of display
+ * @param sprite : sprite to draw
+ * @param x : x position of the upper left corner
+ * @param y : y position of the upper left corner
+ * @param rop : raster operation
+ */
+static void ssd1306_blit_rotated(ssd1306_t *p, const ssd1306_sprite_t *sprite, int32_t x, int32_t y, ssd1306_rop_t rop) {
+    for(uint32_t j=0; j<sprite->height; ++j) {
+        if(y+(int32_t) j<0)
+            continue;
+
+        for(uint32_t i=0; i<sprite->width; ++i) {
+            if(x+(int32_t) i<0)
+                continue;
+
+            const uint32_t src=(j>>3)*sprite->width+i;
+            const uint8_t bit=1<<(j&7);
+            if(sprite->mask&&!(sprite->mask[src]&bit))
+                continue;
+
+            uint32_t bx, by;
+            ssd1306_buffer_pos(p, x+i, y+j, &bx, &by);
+            if(bx<p->clip_x0||bx>p->clip_x1||by<p->clip_y0||by>p->clip_y1)
+                continue;
+
+            uint8_t *dst=p->buffer+bx+SSD1306_W(p)*(by>>3);
+            const uint8_t dbit=1<<(by&7);
+            ssd1306_rop_byte(dst, sprite->data[src]&bit?dbit:0, dbit, rop);
+            ssd1306_mark_dirty(p, bx, bx, by>>3, by>>3);
+        }
+    }
+}
+
+/**
+	@brief draw sprite with a raster operation
+
+	@param p : instance of display
+	@param sprite : sprite to draw
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param rop : raster operation
+
+*/
+void ssd1306_blit(ssd1306_t *p, const ssd1306_sprite_t *sprite, int32_t x, int32_t y, ssd1306_rop_t rop) {
+    const int32_t w=sprite->width, h=sprite->height;
+
+    if(p->rotation!=0) {
+        ssd1306_blit_rotated(p, sprite, x, y, rop);
+        return;
+    }
+
+    const int32_t col0=x>p->clip_x0?x:p->clip_x0, col1=x+w-1<p->clip_x1?x+w-1:p->clip_x1;
+    const int32_t row0=y>p->clip_y0?y:p->clip_y0, row1=y+h-1<p->clip_y1?y+h-1:p->clip_y1;
+    if(col0>col1||row0>row1)
+        return;
+
+    const uint8_t *data=sprite->data+(col0-x), *mask=sprite->mask?sprite->mask+(col0-x):NULL;
+    const uint32_t n=col1-col0+1;
+
+    for(int32_t sp=0; sp<(h+7)>>3; ++sp, data+=w, mask=mask?mask+w:NULL) {
+        const int32_t sy=y+(sp<<3);
+        if(sy+7<row0)
+            continue;
+        if(sy>row1)
+            break;
+
+        const int32_t page=sy>>3, shift=sy&7;
+        const uint8_t bound=(sp<<3)+8>h?0xFF>>((sp<<3)+8-h):0xFF;
+        const uint8_t clip_lo=page>=0?ssd1306_clip_mask(p, page):0;
+        const uint8_t clip_hi=shift?ssd1306_clip_mask(p, page+1):0;
+        uint8_t *dst=p->buffer+page*SSD1306_W(p)+col0;
+
+        if(shift==0&&mask==NULL&&bound==0xFF&&clip_lo==0xFF&&rop==SSD1306_ROP_COPY) { // page aligned
+            memcpy(dst, data, n);
+            continue;
+        }
+
+        for(uint32_t i=0; i<n; ++i) {
+            const uint8_t s=data[i], m=(mask?mask[i]:0xFF)&bound;
+            if(clip_lo)
+                ssd1306_rop_byte(dst+i, s<<shift, (m<<shift)&clip_lo, rop);
+            if(clip_hi)
+                ssd1306_rop_byte(dst+SSD1306_W(p)+i, s>>(8-shift), (m>>(8-shift))&clip_hi, rop);
+        }
+    }
+
+    ssd1306_mark_dirty(p, col0, col1, row0>>3, row1>>3);
+}
+
+/**
+	@brief draw bitmap in page format
+
+	@param p : instance of display
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param bitmap : width, height and pages of the bitmap
+
+*/
+void ssd1306_draw_bitmap(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *bitmap) {
+    const ssd1306_sprite_t sprite= {bitmap[0], bitmap[1], bitmap+2, NULL};
+    ssd1306_blit(p, &sprite, x, y, SSD1306_ROP_OR);
+}
+
+/**
+ * @brief transform a rectangle given in display coordinates into buffer coordinates
+ *
+ * @param p : instance of display
+ * @param x : x position of the upper left corner, may be negative
+ * @param y : y position of the upper left corner, may be negative
+ * @param width : width of rectangle
+ * @param height : height of rectangle
+ * @param r : set to first column, first row, column after the last one and row after the last one
+ */
+inline static void ssd1306_buffer_rect(const ssd1306_t *p, int32_t x, int32_t y, int32_t width, int32_t height, int32_t r[4]) {
+    const int32_t w=SSD1306_W(p), h=SSD1306_H(p);
+
+    switch(p->rotation) {
+    case 0:
+        r[0]=x, r[1]=y, r[2]=x+width, r[3]=y+height;
+        break;
+    case 1:
+        r[0]=w-y-height, r[1]=x, r[2]=w-y, r[3]=x+width;
+        break;
+    case 2:
+        r[0]=w-x-width, r[1]=h-y-height, r[2]=w-x, r[3]=h-y;
+        break;
+    default:
+        r[0]=y, r[1]=h-x-width, r[2]=y+height, r[3]=h-x;
+        break;
+    }
+}
+
+/**
+ * @brief read a byte of a source row, rows outside of the source are empty
+ */
+#define SSD1306_ROW_BYTE(row, i) ((row)?(row)[i]:0)
+
+/**
+ * @brief merge a row of bytes taken from two source pages into the buffer
+ *
+ * Every destination byte gets the bits of lo shifted down by shift and
+ * those of hi shifted up into the rest, the bits of mask are replaced.
+ * Rows of equal alignment are merged a word at a time.
+ *
+ * @param dst : first destination byte
+ * @param lo : first byte of the upper source page, NULL if it is outside of the source
+ * @param hi : first byte of the lower source page, NULL if it is outside of the source
+ * @param n : number of bytes
+ * @param shift : rows the destination starts below the top of lo, 0 to 7
+ * @param mask : bits of each destination byte to replace
+ * @param backward : whether to go from the last byte to the first, for moves to the right within one buffer
+ */
+static void ssd1306_copy_row(uint8_t *dst, const uint8_t *lo, const uint8_t *hi, size_t n, uint32_t shift, uint8_t mask, bool backward) {
+    if(shift==0)
+        hi=NULL;
+    if(shift==0&&mask==0xFF&&lo) {
+        memmove(dst, lo, n);
+        return;
+    }
+
+    const uint8_t keep=0xFF>>shift;
+    size_t head=n, words=0;
+    if(((uintptr_t) dst&3)==((uintptr_t) (lo?lo:dst)&3)&&((uintptr_t) dst&3)==((uintptr_t) (hi?hi:dst)&3)) {
+        head=(4-((uintptr_t) dst&3))&3;
+        if(head>n)
+            head=n;
+        words=(n-head)>>2;
+    }
+    const size_t tail=head+(words<<2);
+
+#define SSD1306_COPY_BYTE(i) \
+    dst[i]=(dst[i]&~mask)|((((SSD1306_ROW_BYTE(lo, i)>>shift)&keep)|(SSD1306_ROW_BYTE(hi, i)<<(8-shift)))&mask)
+
+    if(!backward)
+        for(size_t i=0; i<head; ++i)
+            SSD1306_COPY_BYTE(i);
+    else
+        for(size_t i=n; i>tail; --i)
+            SSD1306_COPY_BYTE(i-1);
+
+    if(words) {
+        const uint32_t keep32=keep*0x01010101u, mask32=mask*0x01010101u;
+
+        for(size_t k=0; k<words; ++k) {
+            const size_t j=head+4*(backward?words-1-k:k);
+            const uint32_t l=lo?ssd1306_load32(lo+j):0, h=hi?ssd1306_load32(hi+j):0;
+            // shifting the whole word moves bits across bytes, keep32 drops them again
+            const uint32_t v=((l>>shift)&keep32)|(shift?(h<<(8-shift))&~keep32:0);
+            ssd1306_store32(dst+j, (ssd1306_load32(dst+j)&~mask32)|(v&mask32));
+        }
+    }
+
+    if(!backward)
+        for(size_t i=tail; i<n; ++i)
+            SSD1306_COPY_BYTE(i);
+    else
+        for(size_t i=head; i>0; --i)
+            SSD1306_COPY_BYTE(i-1);
+
+#undef SSD1306_COPY_BYTE
+}
+
+/**
+	@brief copy a rectangle of one display buffer into another one or within one buffer
+
+	@param dst : display to draw into
+	@param x : x position of the upper left corner in dst, may be negative
+	@param y : y position of the upper left corner in dst, may be negative
+	@param src : display to copy from, may be dst
+	@param src_x : x position of the upper left corner in src, may be negative
+	@param src_y : y position of the upper left corner in src, may be negative
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the displays have different rotations
+
+*/
+bool ssd1306_copy_square(ssd1306_t *dst, int32_t x, int32_t y, const ssd1306_t *src, int32_t src_x, int32_t src_y, uint32_t width, uint32_t height) {
+    if(dst->rotation!=src->rotation)
+        return false;
+    if(width==0||height==0||width>INT16_MAX||height>INT16_MAX)
+        return true;
+
+    // with equal rotations the rectangles are moved in the buffers by a translation
+    int32_t d[4], s[4];
+    ssd1306_buffer_rect(dst, x, y, width, height, d);
+    ssd1306_buffer_rect(src, src_x, src_y, width, height, s);
+    const int32_t tx=d[0]-s[0], ty=d[1]-s[1];
+
+    // rows and columns outside of the source are not copied at all
+    const int32_t limits[4]= {
+        s[0]>0?s[0]:0, s[1]>0?s[1]:0,
+        s[2]<(int32_t) SSD1306_W(src)?s[2]:(int32_t) SSD1306_W(src),
+        s[3]<(int32_t) SSD1306_H(src)?s[3]:(int32_t) SSD1306_H(src),
+    };
+    const int32_t bx0=limits[0]+tx>dst->clip_x0?limits[0]+tx:dst->clip_x0;
+    const int32_t by0=limits[1]+ty>dst->clip_y0?limits[1]+ty:dst->clip_y0;
+    const int32_t bx1=limits[2]+tx<dst->clip_x1+1?limits[2]+tx:dst->clip_x1+1;
+    const int32_t by1=limits[3]+ty<dst->clip_y1+1?limits[3]+ty:dst->clip_y1+1;
+    if(bx0>=bx1||by0>=by1)
+        return true;
+
+    const bool same=dst->buffer==src->buffer;
+    const int32_t sw=SSD1306_W(src), dw=SSD1306_W(dst);
+    // a band being rendered only holds its own pages
+    const int32_t sp0=ssd1306_in_band(src)?src->band_p0:0, sp1=ssd1306_in_band(src)?src->band_p1:(SSD1306_H(src)>>3)-1;
+    const int32_t page0=by0>>3, page1=(by1-1)>>3;
+
+    // moves down or right within one buffer start at the far end, so no source byte is overwritten before it is read
+    const bool up=same&&ty>0, backward=same&&tx>0;
+    for(int32_t k=0; k<=page1-page0; ++k) {
+        const int32_t page=up?page1-k:page0+k;
+        uint8_t mask=0xFF;
+        if(page==page0)
+            mask&=0xFF<<(by0&7);
+        if(page==page1)
+            mask&=0xFF>>(7-((by1-1)&7));
+
+        const int32_t row=(page<<3)-ty, lp=row>>3; // arithmetic shift, rows above the source are left out
+        const uint8_t *lo=lp>=sp0&&lp<=sp1?src->buffer+lp*sw+bx0-tx:NULL;
+        const uint8_t *hi=lp+1>=sp0&&lp+1<=sp1?src->buffer+(lp+1)*sw+bx0-tx:NULL;
+
+        ssd1306_copy_row(dst->buffer+page*dw+bx0, lo, hi, bx1-bx0, row&7, mask, backward);
+    }
+
+    ssd1306_mark_dirty(dst, bx0, bx1-1, page0, page1);
+
+    return true;
+}
+
+/**
+	@brief shift the contents of the clip rectangle
+
+	@param p : instance of display
+	@param dx : pixels to move right, negative to move left
+	@param dy : pixels to move down, negative to move up
+	@note the pixels moved in are cleared
+
+*/
+void ssd1306_shift(ssd1306_t *p, int32_t dx, int32_t dy) {
+    int32_t x0, y0, x1, y1;
+    ssd1306_get_clip(p, &x0, &y0, &x1, &y1);
+    if(x0>x1||y0>y1)
+        return;
+
+    const int32_t w=x1-x0+1, h=y1-y0+1;
+    ssd1306_copy_square(p, x0+dx, y0+dy, p, x0, y0, w, h);
+
+    // the moved in parts, fill_rect cuts them to the clip rectangle
+    if(dx>0)
+        ssd1306_fill_rect(p, x0, y0, dx<w?dx:w, h, SSD1306_DRAW_CLEAR);
+    else if(dx<0)
+        ssd1306_fill_rect(p, -dx<w?x1+1+dx:x0, y0, -dx<w?-dx:w, h, SSD1306_DRAW_CLEAR);
+    if(dy>0)
+        ssd1306_fill_rect(p, x0, y0, w, dy<h?dy:h, SSD1306_DRAW_CLEAR);
+    else if(dy<0)
+        ssd1306_fill_rect(p, x0, -dy<h?y1+1+dy:y0, w, -dy<h?-dy:h, SSD1306_DRAW_CLEAR);
+}
+
+/**
+ * @brief where decoded RLE bytes are drawn
+ */
+typedef struct {
+    int32_t x;	/**< x position of column 0 */
+    int32_t y;	/**< y position of page 0 */
+    uint32_t scale;	/**< pixels per decoded pixel */
+    uint32_t height;	/**< rows of the unscaled picture */
+    uint8_t mode;	/**< SSD1306_DRAW_* operation */
+} ssd1306_rle_target_t;
+
+/**
+ * @brief draw a decoded byte of page format data
+ *
+ * @param p : instance of display
+ * @param t : target
+ * @param col : column of the byte
+ * @param page : page of the byte
+ * @param b : byte, top pixel in bit 0
+ */
+static void ssd1306_rle_put(ssd1306_t *p, const ssd1306_rle_target_t *t, uint32_t col, uint32_t page, uint8_t b) {
+    if(t->scale==1) {
+        static const uint8_t zero=0;
+        const uint8_t rows=t->height-(page<<3)<8?t->height-(page<<3):8;
+        const ssd1306_sprite_t sprite= {1, rows, t->mode==SSD1306_DRAW_CLEAR?&zero:&b, t->mode==SSD1306_DRAW_CLEAR?&b:NULL};
+        const ssd1306_rop_t rop=t->mode==SSD1306_DRAW_SET?SSD1306_ROP_OR:t->mode==SSD1306_DRAW_XOR?SSD1306_ROP_XOR:SSD1306_ROP_COPY;
+        ssd1306_blit(p, &sprite, t->x+col, t->y+(page<<3), rop);
+        return;
+    }
+
+    for(uint32_t j=0; j<8; ) {
+        if(!(b>>j&1)) {
+            ++j;
+            continue;
+        }
+        uint32_t run=1;
+        while(j+run<8&&b>>(j+run)&1)
+            ++run;
+        ssd1306_fill_rect(p, t->x+col*t->scale, t->y+((page<<3)+j)*t->scale, t->scale, run*t->scale, t->mode);
+        j+=run;
+    }
+}
+
+/**
+ * @brief decode RLE data straight into the display buffer
+ *
+ * A control byte c below 128 is followed by c+1 literal bytes, from 128 on
+ * it is followed by one byte repeated c-126 times. Zero bytes are not drawn.
+ *
+ * @param p : instance of display
+ * @param t : target
+ * @param src : RLE data
+ * @param skip : decoded bytes to pass over before drawing
+ * @param n : decoded bytes to draw
+ * @param inner : length of the dimension that changes first
+ * @param page_inner : whether that dimension is the page (column major) instead of the column (page major)
+ */
+static void ssd1306_rle_decode(ssd1306_t *p, const ssd1306_rle_target_t *t, const uint8_t *src, uint32_t skip, uint32_t n, uint32_t inner, bool page_inner) {
+    uint32_t a=0, b=0; // position along the inner and the outer dimension
+
+    while(n) {
+        const uint8_t c=*src++;
+        const bool run=c>=128;
+        uint32_t count=run?c-126u:c+1u;
+
+        if(skip) {
+            const uint32_t s=skip<count?skip:count;
+            skip-=s;
+            count-=s;
+            if(!run)
+                src+=s;
+        }
+        if(count>n)
+            count=n;
+        n-=count;
+
+        const uint8_t v=run?*src++:0;
+        if(run&&v==0) {
+            a+=count;
+            b+=a/inner;
+            a%=inner;
+            continue;
+        }
 
-    return true;
+        for(; count; --count) {
+            const uint8_t d=run?v:*src++;
+            if(d) {
+                if(page_inner)
+                    ssd1306_rle_put(p, t, b, a, d);
+                else
+                    ssd1306_rle_put(p, t, a, b, d);
+            }
+            if(++a==inner) {
+                a=0;
+                ++b;
+            }
+        }
+    }
 }
 
 /**
-*	@brief deinitialize display
-*
-*	@param p : instance of display
-*
+	@brief draw a RLE compressed bitmap
+
+	@param p : instance of display
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param bitmap : width, height and the RLE compressed pages of the bitmap
+
 */
-inline void ssd1306_deinit(ssd1306_t *p) {
-    free(p->buffer-1);
+void ssd1306_draw_rle_bitmap(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *bitmap) {
+    const ssd1306_rle_target_t t= {(int32_t) x, (int32_t) y, 1, bitmap[1], SSD1306_DRAW_SET};
+
+    if(bitmap[0]&&bitmap[1])
+        ssd1306_rle_decode(p, &t, bitmap+2, 0, bitmap[0]*((bitmap[1]+7u)>>3), bitmap[0], false);
 }
 
 /**
-*	@brief turn off display
-*
-*	@param p : instance of display
-*
+ * @brief draw a char of a RLE compressed font
+ *
+ * @param p : instance of display
+ * @param x : x position of the char
+ * @param y : y position of the char
+ * @param scale : scale
+ * @param font : RLE compressed font
+ * @param c : character
+ * @param mode : SSD1306_DRAW_* operation
+ */
+static void ssd1306_rle_glyph(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c, uint8_t mode) {
+    if(c<font[3]||c>font[4])
+        return;
+
+    const uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0), size=font[1]*parts_per_line;
+    const uint32_t groups=(font[4]-font[3]+SSD1306_RLE_FONT_GROUP)/SSD1306_RLE_FONT_GROUP, k=c-font[3];
+    const uint8_t *offset=font+5+2*(k/SSD1306_RLE_FONT_GROUP);
+    const ssd1306_rle_target_t t= {(int32_t) x, (int32_t) y, scale, parts_per_line<<3, mode};
+
+    // only the start of each group of chars is known, the chars in front are decoded without drawing
+    ssd1306_rle_decode(p, &t, font+5+2*groups+(offset[0]|offset[1]<<8), (k%SSD1306_RLE_FONT_GROUP)*size, size, parts_per_line, true);
+}
+
+/**
+	@brief draw char with a RLE compressed font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to RLE compressed font
+	@param c : character to draw
+
 */
-inline void ssd1306_poweroff(ssd1306_t *p) {
-    ssd1306_write(p, SET_DISP|0x00);
+void ssd1306_draw_char_with_rle_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
+    if(scale==0)
+        return;
+    ssd1306_rle_glyph(p, x, y, scale, font, c, p->mode);
 }
 
 /**
-	@brief turn on display
+	@brief draw string with a RLE compressed font
 
 	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to RLE compressed font
+	@param s : text to draw
 
 */
-inline void ssd1306_poweron(ssd1306_t *p) {
-    ssd1306_write(p, SET_DISP|0x01);
+void ssd1306_draw_string_with_rle_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
+    if(scale==0)
+        return;
+
+    for(int32_t x_n=x; *s; ++s, x_n+=(font[1]+font[2])*scale)
+        ssd1306_rle_glyph(p, x_n, y, scale, font, *s, p->mode);
 }
 
 /**
-	@brief set contrast of display
+	@brief draw monochrome bitmap with offset
 
 	@param p : instance of display
-	@param val : contrast
+	@param data : image data (whole file)
+	@param size : size of image data in bytes
+	@param x_offset : offset of horizontal coordinate
+	@param y_offset : offset of vertical coordinate
+*/
+void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const long size, uint32_t x_offset, uint32_t y_offset) {
+    if(size<54) // data smaller than header
+        return;
+
+    const uint32_t bfOffBits=ssd1306_bmp_get_val(data, 10, 4);
+    const uint32_t biSize=ssd1306_bmp_get_val(data, 14, 4);
+    const uint32_t biWidth=ssd1306_bmp_get_val(data, 18, 4);
+    const int32_t biHeight=(int32_t) ssd1306_bmp_get_val(data, 22, 4);
+    const uint16_t biBitCount=(uint16_t) ssd1306_bmp_get_val(data, 28, 2);
+    const uint32_t biCompression=ssd1306_bmp_get_val(data, 30, 4);
+
+    if(biBitCount!=1) // image not monochrome
+        return;
+
+    if(biCompression!=0) // image compressed
+        return;
+
+    const int table_start=14+biSize;
+    uint8_t color_val=0;
+
+    for(uint8_t i=0; i<2; ++i) {
+        if(!((data[table_start+i*4]<<16)|(data[table_start+i*4+1]<<8)|data[table_start+i*4+2])) {
+            color_val=i;
+            break;
+        }
+    }
+
+    uint32_t bytes_per_line=(biWidth/8)+(biWidth&7?1:0);
+    if(bytes_per_line&3)
+        bytes_per_line=(bytes_per_line^(bytes_per_line&3))+4;
+
+    const uint8_t *img_data=data+bfOffBits;
+
+    if(p->rotation==0) {
+        ssd1306_bmp_blit(p, img_data, biWidth, biHeight, bytes_per_line, color_val, x_offset, y_offset);
+        return;
+    }
+
+    int32_t step=biHeight>0?-1:1;
+    int32_t border=biHeight>0?-1:-biHeight;
+
+    const ssd1306_pixel_fn_t px=p->draw_pixel_fn;
+
+    for(uint32_t y=biHeight>0?biHeight-1:0; y!=(uint32_t)border; y+=step) {
+        for(uint32_t x=0; x<biWidth; ++x) {
+            if(((img_data[x>>3]>>(7-(x&7)))&1)==color_val)
+                px(p, x_offset+x, y_offset+y);
+        }
+        img_data+=bytes_per_line;
+    }
+}
+
+/**
+	@brief draw monochrome bitmap
 
+	@param p : instance of display
+	@param data : image data (whole file)
+	@param size : size of image data in bytes
 */
-inline void ssd1306_contrast(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_CONTRAST);
-    ssd1306_write(p, val);
+inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size) {
+    ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
 }
 
 /**
-	@brief set invert display
+	@brief display buffer, should be called on change
 
 	@param p : instance of display
-	@param inv : inv==0: disable inverting, inv!=0: invert
+
+	@return int.
+	@retval PICO_OK for Success
+	@retval PICO_ERROR_GENERIC if the display did not acknowledge a transfer since the last show
+	@retval PICO_ERROR_TIMEOUT if a transfer since the last show timed out (I2C with SSD1306_I2C_TIMEOUT_US defined)
+	@retval PICO_ERROR_NOT_PERMITTED if called from the render function of ssd1306_show_bands
 
 */
-inline void ssd1306_invert(ssd1306_t *p, uint8_t inv) {
-    ssd1306_write(p, SET_NORM_INV | (inv & 1));
+int ssd1306_show(ssd1306_t *p) {
+    if(ssd1306_in_band(p))
+        return PICO_ERROR_NOT_PERMITTED;
+
+    const uint64_t start=ssd1306_frame_begin(p);
+
+    ssd1306_show_diff(p, p->buffer, 0, p->width-1, 0, p->pages-1);
+    ssd1306_reset_dirty(p);
+
+    ssd1306_frame_end(p, start, true);
+
+    return ssd1306_take_error(p);
 }
 
 /**
-	@brief set vertical flip of display
+	@brief display only the part of the buffer changed since the last show
 
 	@param p : instance of display
-	@param val : val==0: disable flip, val!=0: flip
+
+	@return int, see ssd1306_show
 
 */
-inline void ssd1306_vflip(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_COM_OUT_DIR | (!val << 3));
+int ssd1306_show_dirty(ssd1306_t *p) {
+    if(ssd1306_in_band(p))
+        return PICO_ERROR_NOT_PERMITTED;
+    if(p->dirty_x0>p->dirty_x1||p->dirty_p0>p->dirty_p1)
+        return ssd1306_take_error(p);
+
+    const uint64_t start=ssd1306_frame_begin(p);
+
+    ssd1306_show_diff(p, p->buffer, p->dirty_x0, p->dirty_x1, p->dirty_p0, p->dirty_p1);
+    ssd1306_reset_dirty(p);
+
+    ssd1306_frame_end(p, start, true);
+
+    return ssd1306_take_error(p);
 }
 
 /**
-	@brief set horizontal flop of display
+	@brief display a window of a frame other than the buffer
 
 	@param p : instance of display
-	@param val : val==0: disable flop, val!=0: flop
+	@param frame : frame laid out like p->buffer, frame[-1] must be writable
+	@param x0 : first column
+	@param x1 : last column
+	@param p0 : first page
+	@param p1 : last page
+
+	@return int, see ssd1306_show
 
 */
-inline void ssd1306_hflip(ssd1306_t *p, uint8_t val) {
-    ssd1306_write(p, SET_SEG_REMAP | (!val & 1));
+int ssd1306_show_frame(ssd1306_t *p, uint8_t *frame, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1) {
+    if(x0<=x1&&x1<p->width&&p0<=p1&&p1<p->pages)
+        ssd1306_show_diff(p, frame, x0, x1, p0, p1);
+
+    return ssd1306_take_error(p);
 }
 
+#ifndef SSD1306_NO_STATS
 /**
-	@brief Outdated: set hardware rotation of display to 180°
+	@brief get the counters of a display
 
 	@param p : instance of display
-	@param val : val==0: disable rotation, val!=0: rotate
-	@note Included for backwards support. Use ssd1306_set_rotation instead
+	@param stats : set to a copy of p->stats, with the averages computed
 
 */
-inline void ssd1306_rotate(ssd1306_t *p, uint8_t val) {
-    ssd1306_vflip(p, val);
-    ssd1306_hflip(p, val);
+void ssd1306_get_stats(ssd1306_t *p, ssd1306_stats_t *stats) {
+    *stats=p->stats;
+    stats->render.avg=stats->render.n?stats->render.total/stats->render.n:0;
+    stats->transfer.avg=stats->transfer.n?stats->transfer.total/stats->transfer.n:0;
 }
 
 /**
-	@brief set display rotation
+	@brief reset the counters of a display
 
 	@param p : instance of display
-	@param rotation : 0: no rotation, 1: 90°, 2: 180°, 3: 270°
 
 */
-inline void ssd1306_set_rotation(ssd1306_t *p, uint8_t rotation) {
-    if(rotation > 3) {
+void ssd1306_reset_stats(ssd1306_t *p) {
+    memset(&p->stats, 0, sizeof(p->stats));
+}
+#endif
+
+/**
+ * @brief move the rows of the display buffer up or down
+ *
+ * @param p : instance of display
+ * @param rows : rows to move up, negative to move down, less than the height
+ */
+static void ssd1306_shift_rows(ssd1306_t *p, int32_t rows) {
+    const uint32_t w=p->width, n=rows<0?-rows:rows, pg=n>>3, b=n&7;
+    uint8_t *buf=p->buffer;
+
+    if(b==0) {
+        if(rows>0)
+            memmove(buf, buf+pg*w, (p->pages-pg)*w);
+        else
+            memmove(buf+pg*w, buf, (p->pages-pg)*w);
+        memset(rows>0?buf+(p->pages-pg)*w:buf, 0, pg*w);
         return;
     }
 
-    p->rotation = rotation;
+    if(rows>0) {
+        for(uint32_t k=0; k<p->pages; ++k) {
+            for(uint32_t x=0; x<w; ++x) {
+                const uint8_t lo=k+pg<p->pages?buf[(k+pg)*w+x]:0;
+                const uint8_t hi=k+pg+1<p->pages?buf[(k+pg+1)*w+x]:0;
+                buf[k*w+x]=(lo>>b)|(hi<<(8-b));
+            }
+        }
+    } else {
+        for(uint32_t k=p->pages; k--;) {
+            for(uint32_t x=0; x<w; ++x) {
+                const uint8_t hi=k>=pg?buf[(k-pg)*w+x]:0;
+                const uint8_t lo=k>=pg+1?buf[(k-pg-1)*w+x]:0;
+                buf[k*w+x]=(hi<<b)|(lo>>(8-b));
+            }
+        }
+    }
 }
 
 /**
-	@brief clear display buffer
+	@brief scroll the display by moving its start line
+
+	The buffer is moved along, the exposed rows are cleared and only the pages
+	holding them are sent, followed by a single start line command.
 
 	@param p : instance of display
+	@param rows : rows to scroll up, negative to scroll down
+	@note rows are those of the unrotated display, the clip rectangle is ignored. Pending changes are sent first. With double buffering, the back buffer is scrolled.
 
 */
-inline void ssd1306_clear(ssd1306_t *p) {
-    memset(p->buffer, 0, p->bufsize);
+void ssd1306_scroll_rows(ssd1306_t *p, int32_t rows) {
+    if(rows==0||ssd1306_in_band(p))
+        return;
+
+    if(rows>=p->height||-rows>=p->height) {
+        memset(p->buffer, 0, p->bufsize);
+        ssd1306_mark_dirty(p, 0, p->width-1, 0, p->pages-1);
+        ssd1306_show_dirty(p);
+        return;
+    }
+
+    ssd1306_show_dirty(p);
+    ssd1306_shift_rows(p, rows);
+    p->start_line=(p->start_line+rows)&63;
+
+    // the exposed rows replace rows scrolling out, so they can be sent before the start line moves
+    if(rows>0)
+        ssd1306_show_window(p, p->buffer, 0, p->width-1, (p->height-rows)>>3, p->pages-1);
+    else
+        ssd1306_show_window(p, p->buffer, 0, p->width-1, 0, (-rows-1)>>3);
+    ssd1306_write(p, SET_DISP_START_LINE|p->start_line);
+
+    // the display memory moved along with the buffer
+    if(p->shadow&&p->shadow_valid)
+        memcpy(p->shadow, p->buffer, p->bufsize);
 }
 
 /**
-	@brief clear pixel on buffer
+	@brief start continuous horizontal scrolling in the display
 
 	@param p : instance of display
-	@param x : x position
-	@param y : y position
+	@param left : true to scroll left, false to scroll right
+	@param start_page : first page to scroll
+	@param end_page : last page to scroll
+	@param interval : frames between steps, 0: 5, 1: 64, 2: 128, 3: 256, 4: 3, 5: 4, 6: 25, 7: 2
+	@note do not send data while the display scrolls, stop it with ssd1306_scroll_stop first
+
 */
-void ssd1306_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
-    uint32_t buffer_x, buffer_y;
-    switch (p->rotation) {
-        case 0:
-            buffer_x = x;
-            buffer_y = y;
-            break;
-        case 1:
-            buffer_x = p->height - 1 - y + (p->width) / 2;
-            buffer_y = x;
-            break;
-        case 2:
-            buffer_x = p->width - 1 - x;
-            buffer_y = p->height - 1 - y;
-            break;
-        case 3:
-            buffer_x = y;
-            buffer_y = p->height - 1 - x;
-            break;
-    }
+void ssd1306_scroll_horizontal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval) {
+    uint8_t cmds[]= {
+        SET_SCROLL_OFF,
+        left?SET_SCROLL_LEFT:SET_SCROLL_RIGHT,
+        0x00,
+        start_page&7,
+        interval&7,
+        end_page&7,
+        0x00,
+        0xFF,
+        SET_SCROLL_ON
+    };
 
-    if (buffer_x < p->width && buffer_y < p->height) {
-        p->buffer[buffer_x + p->width * (buffer_y >> 3)] &= ~(0x1 << (buffer_y & 0x07));
-    }
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+    p->shadow_valid=false;
 }
 
 /**
-	@brief reset display
+	@brief start continuous diagonal scrolling in the display
 
 	@param p : instance of display
+	@param left : true to scroll left, false to scroll right
+	@param start_page : first page to scroll horizontally
+	@param end_page : last page to scroll horizontally
+	@param interval : frames between steps, see ssd1306_scroll_horizontal
+	@param offset : rows to scroll up per step, 1 to 63
+	@note do not send data while the display scrolls, stop it with ssd1306_scroll_stop first
+
 */
-void ssd1306_reset(ssd1306_t *p) {
-    uint8_t payload[] = {
-        SET_COMMAND_MODE,
-        SET_DISP,
-        SET_ENTIRE_ON,
-        SET_DISP_CLK_DIV,
-        0x80,
-        SET_CHARGE_PUMP,
-        0x14,
-        SET_NORM_INV,
-        SET_DISP_OFFSET,
+void ssd1306_scroll_diagonal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval, uint8_t offset) {
+    uint8_t cmds[]= {
+        SET_SCROLL_OFF,
+        SET_VERT_SCROLL_AREA,
         0x00,
-        SET_DISP_START_LINE,
-        SET_DISP_ON
+        p->height,
+        left?SET_SCROLL_VERT_LEFT:SET_SCROLL_VERT_RIGHT,
+        0x00,
+        start_page&7,
+        interval&7,
+        end_page&7,
+        offset&63,
+        SET_SCROLL_ON
     };
 
-    for (size_t i = 0; i < sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+    p->shadow_valid=false;
 }
 
 /**
-	@brief draw pixel on buffer
+	@brief stop hardware scrolling
 
 	@param p : instance of display
-	@param x : x position
-	@param y : y position
+	@note the display memory is out of date afterwards, the whole buffer is sent with the next ssd1306_show_dirty
+
 */
-void ssd1306_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) {
-    uint32_t buffer_x, buffer_y;
-    switch (p->rotation) {
-        case 0:
-            buffer_x = x;
-            buffer_y = y;
-            break;
-        case 1:
-            buffer_x = p->height - 1 - y + p->width / 2;
-            buffer_y = x;
-            break;
-        case 2:
-            buffer_x = p->width - 1 - x;
-            buffer_y = p->height - 1 - y;
-            break;
-        case 3:
-            buffer_x = y;
-            buffer_y = p->height - 1 - x;
-            break;
-    }
+void ssd1306_scroll_stop(ssd1306_t *p) {
+    uint8_t cmds[]= {SET_SCROLL_OFF, SET_DISP_START_LINE};
+
+    ssd1306_write_cmds(p, cmds, sizeof(cmds));
+    p->start_line=0;
+    p->shadow_valid=false;
+    ssd1306_mark_dirty(p, 0, p->width-1, 0, p->pages-1);
+}
 
-    if (buffer_x < p->width && buffer_y < p->height) {
-        p->buffer[buffer_x + p->width * (buffer_y >> 3)] |= 0x1 << (buffer_y & 0x07);
+/**
+ * @brief DMA interrupt handler, shared by all displays
+ */
+static void ssd1306_dma_irq_handler(void) {
+    for(uint32_t i=0; i<NUM_DMA_CHANNELS; ++i) {
+        ssd1306_t *p=ssd1306_dma_owner[i];
+        if(p==NULL||!dma_channel_get_irq0_status(i))
+            continue;
+
+        dma_channel_acknowledge_irq0(i);
+        if(p->show_cb)
+            p->show_cb(p);
     }
 }
 
 /**
-	@brief draw line on buffer
+ * @brief allocate the DMA channel of a display
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true if the display is ready for asynchronous transfers
+ */
+static bool ssd1306_dma_claim(ssd1306_t *p) {
+    static bool irq_installed=false;
 
-	@param p : instance of display
-	@param x1 : x position of starting point
-	@param y1 : y position of starting point
-	@param x2 : x position of end point
-	@param y2 : y position of end point
-*/
-void ssd1306_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
-    if(x1>x2) {
-        swap(&x1, &x2);
-        swap(&y1, &y2);
+    if(p->dma_chan>=0)
+        return true;
+
+    int chan=dma_claim_unused_channel(false);
+    if(chan<0)
+        return false;
+
+    if(!irq_installed) {
+        irq_add_shared_handler(DMA_IRQ_0, ssd1306_dma_irq_handler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        irq_set_enabled(DMA_IRQ_0, true);
+        irq_installed=true;
     }
 
-    if(x1==x2) {
-        if(y1>y2)
-            swap(&y1, &y2);
-        for(int32_t i=y1; i<=y2; ++i)
-            ssd1306_draw_pixel(p, x1, i);
-        return;
+    ssd1306_dma_owner[chan]=p;
+    dma_channel_set_irq0_enabled(chan, true);
+    p->dma_chan=chan;
+
+    return true;
+}
+
+/**
+ * @brief start sending a window of a frame through the transport of the display
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return bool.
+ * @retval false if the transport could not start the transfer
+ */
+static bool ssd1306_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    const size_t n=p->transport->start_async(p, src, x0, x1, p0, p1);
+    if(n==0)
+        return false;
+
+    // transports may widen the window, so count what was actually queued
+    ssd1306_count_transfer(p, n);
+
+    return true;
+}
+
+/**
+ * @brief start a DMA transfer of a window of a frame
+ *
+ * The window commands and the frame data are put into one I2C command
+ * stream: the IC_DATA_CMD register ignores the width of bus writes, so
+ * the bytes can not be fed from the frame directly. A moved start line is
+ * reset behind the data, so the window has to cover the whole frame then.
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column
+ * @param x1 : last column
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return number of command and data bytes queued, 0 if the command stream of ssd1306_enable_async is missing or too small for the window
+ */
+static size_t ssd1306_i2c_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if((x1-x0+1)*(p1-p0+1)>p->dma_size)
+        return 0;
+
+    uint8_t cmds[6];
+    ssd1306_window_cmds(p, cmds, x0, x1, p0, p1);
+
+    uint16_t *d=p->dma_buf;
+    *d++=SET_COMMAND_MODE;
+    for(size_t i=0; i<sizeof(cmds); ++i)
+        *d++=cmds[i];
+
+    *d++=I2C_IC_DATA_CMD_RESTART_BITS|0x40;
+    for(uint32_t page=p0; page<=p1; ++page) {
+        const uint8_t *row=src+page*p->width;
+        for(uint32_t x=x0; x<=x1; ++x)
+            *d++=row[x];
+    }
+    if(p->start_line) {
+        *d++=I2C_IC_DATA_CMD_RESTART_BITS|SET_COMMAND_MODE;
+        *d++=SET_DISP_START_LINE;
+        p->start_line=0;
     }
+    *(d-1)|=I2C_IC_DATA_CMD_STOP_BITS;
 
-    float m=(float) (y2-y1) / (float) (x2-x1);
+    i2c_hw_t *hw=i2c_get_hw(p->i2c_i);
+    hw->enable=0;
+    hw->tar=p->address;
+    hw->enable=1;
 
-    for(int32_t i=x1; i<=x2; ++i) {
-        float y=m*(float) (i-x1)+(float) y1;
-        ssd1306_draw_pixel(p, i, (uint32_t) y);
-    }
-}
+    dma_channel_config c=dma_channel_get_default_config(p->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_16);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, i2c_get_dreq(p->i2c_i, true));
 
-/**
-	@brief clear square at given position with given size
+    dma_channel_configure(p->dma_chan, &c, &hw->data_cmd, p->dma_buf, d-p->dma_buf, true);
 
-	@param p : instance of display
-	@param x : x position of starting point
-	@param y : y position of starting point
-	@param width : width of square
-	@param height : height of square
-*/
-void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_clear_pixel(p, x+i, y+j);
+    // without the two control bytes
+    return d-p->dma_buf-2;
 }
 
 /**
-	@brief draw filled square at given position with given size
+	@brief prepare a display for asynchronous transfers
 
 	@param p : instance of display
-	@param x : x position of starting point
-	@param y : y position of starting point
-	@param width : width of square
-	@param height : height of square
+	@param pages : pages of the largest window to send without blocking
+	@return bool.
+	@retval true for Success
+	@retval false if pages is 0 or the stream could not be allocated
+
 */
-void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    for(uint32_t i=0; i<width; ++i)
-        for(uint32_t j=0; j<height; ++j)
-            ssd1306_draw_pixel(p, x+i, y+j);
+bool ssd1306_enable_async(ssd1306_t *p, uint8_t pages) {
+    if(pages==0)
+        return false;
+    if(pages>p->pages)
+        pages=p->pages;
+
+    const size_t size=(size_t) pages*p->width;
+    if(p->transport!=&ssd1306_i2c_transport||size<=p->dma_size)
+        return true;
+
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    uint16_t *stream=malloc(SSD1306_ASYNC_SIZE(p->width, pages));
+    if(stream==NULL)
+        return false;
+
+    free(p->dma_buf);
+    p->dma_buf=stream;
+    p->dma_size=size;
+
+    return true;
 }
 
 /**
-	@brief draw empty square at given position with given size
+	@brief display buffer without blocking, using DMA
 
 	@param p : instance of display
-	@param x : x position of starting point
-	@param y : y position of starting point
-	@param width : width of square
-	@param height : height of square
+	@return bool.
+	@retval true if the transfer was started
+	@retval false if a transfer is still running, no DMA channel/memory is available or a band is rendered
+
 */
-void ssd1306_draw_empty_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) {
-    ssd1306_draw_line(p, x, y, x+width, y);
-    ssd1306_draw_line(p, x, y+height, x+width, y+height);
-    ssd1306_draw_line(p, x, y, x, y+height);
-    ssd1306_draw_line(p, x+width, y, x+width, y+height);
+bool ssd1306_show_async(ssd1306_t *p) {
+    if(ssd1306_in_band(p)||ssd1306_is_busy(p)||!ssd1306_dma_claim(p)||!ssd1306_start_async(p, p->buffer, 0, p->width-1, 0, p->pages-1))
+        return false;
+
+    ssd1306_frame_end(p, ssd1306_frame_begin(p), false);
+    ssd1306_shadow_sent(p, p->buffer, 0, p->width-1, 0, p->pages-1);
+    ssd1306_reset_dirty(p);
+
+    return true;
 }
 
 /**
-	@brief clear filled circle at given position with given radius
+	@brief check whether an asynchronous transfer is still running
 
 	@param p : instance of display
-	@param x : x position of the center of the circle
-	@param y : y position of the center of the circle
-	@param r : radius of the circle
+	@return bool.
+	@retval true while data of ssd1306_show_async is still being sent
+
 */
-void ssd1306_clear_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
-    for (uint32_t i = 0; i < r; ++i) {
-        for (uint32_t j = 0; j < r; ++j) {
-            if ((i * i + j * j) <= (r * r)) {
-                ssd1306_clear_pixel(p, x + i, y + j);
-                ssd1306_clear_pixel(p, x + i, y - j);
-                ssd1306_clear_pixel(p, x - i, y + j);
-                ssd1306_clear_pixel(p, x - i, y - j);
-            }
-        }
-    }
+bool ssd1306_is_busy(ssd1306_t *p) {
+    if(p->dma_chan<0)
+        return false;
+
+    return p->transport->is_busy(p);
 }
 
 /**
-	@brief draw filled circle at given position with given radius
+ * @brief check whether the I2C controller is still sending the DMA stream
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true while the DMA channel or the controller are active
+ */
+static bool ssd1306_i2c_is_busy(ssd1306_t *p) {
+    i2c_hw_t *hw=i2c_get_hw(p->i2c_i);
+    if(dma_channel_is_busy(p->dma_chan)||!(hw->status&I2C_IC_STATUS_TFE_BITS)||(hw->status&I2C_IC_STATUS_MST_ACTIVITY_BITS))
+        return true;
 
-	@param p : instance of display
-	@param x : x position of the center of the circle
-	@param y : y position of the center of the circle
-	@param r : radius of the circle
-*/
-void ssd1306_draw_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
-    for (uint32_t i = 0; i < r; ++i) {
-        for (uint32_t j = 0; j < r; ++j) {
-            if ((i * i + j * j) <= (r * r)) {
-                ssd1306_draw_pixel(p, x + i, y + j);
-                ssd1306_draw_pixel(p, x + i, y - j);
-                ssd1306_draw_pixel(p, x - i, y + j);
-                ssd1306_draw_pixel(p, x - i, y - j);
-            }
-        }
-    }
+    // a not acknowledged address or byte aborts the rest of the stream
+    if(hw->raw_intr_stat&I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+        ssd1306_transfer_error(p, PICO_ERROR_GENERIC);
+
+    // the SDK expects these to be clear when it starts a transfer
+    (void) hw->clr_stop_det;
+    (void) hw->clr_tx_abrt;
+
+    return false;
 }
 
 /**
-	@brief draw empty circle at given position with given radius
+	@brief set callback for asynchronous transfers
 
 	@param p : instance of display
-	@param x : x position of the center of the circle
-	@param y : y position of the center of the circle
-	@param r : radius of the circle
+	@param cb : function called from the DMA interrupt, NULL to disable
+
 */
-void ssd1306_draw_empty_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r) {
-    for (uint32_t i = 0; i < r; ++i) {
-        for (uint32_t j = 0; j < r; ++j) {
-            if ((i * i + j * j) >= ((r - 1) * (r - 1)) && (i * i + j * j) <= (r * r)) {
-                ssd1306_draw_pixel(p, x + i, y + j);
-                ssd1306_draw_pixel(p, x + i, y - j);
-                ssd1306_draw_pixel(p, x - i, y + j);
-                ssd1306_draw_pixel(p, x - i, y - j);
-            }
-        }
-    }
+inline void ssd1306_set_show_callback(ssd1306_t *p, void (*cb)(ssd1306_t *p)) {
+    p->show_cb=cb;
 }
 
 /**
-	@brief clear char with given font
+	@brief enable double buffering
 
 	@param p : instance of display
-	@param x : x starting position of char
-	@param y : y starting position of char
-	@param scale : scale font to n times of original size (default should be 1)
-	@param font : pointer to font
-	@param c : character to clear
+	@return bool.
+	@retval true for Success
+	@retval false if the second buffer could not be allocated or a band is rendered
+
 */
-void ssd1306_clear_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
-    if(c<font[3]||c>font[4])
-        return;
+bool ssd1306_enable_double_buffer(ssd1306_t *p) {
+    if(p->front)
+        return true;
+    if(ssd1306_in_band(p))
+        return false;
 
-    uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
-    for(uint8_t w=0; w<font[1]; ++w) { // width
-        uint32_t pp=(c-font[3])*font[1]*parts_per_line+w*parts_per_line+5;
-        for(uint32_t lp=0; lp<parts_per_line; ++lp) {
-            uint8_t line=font[pp];
+    if((p->front=malloc(p->bufsize+1))==NULL)
+        return false;
 
-            for(int8_t j=0; j<8; ++j, line>>=1) {
-                if(line & 1)
-                    ssd1306_clear_square(p, x+w*scale, y+((lp<<3)+j)*scale, scale, scale);
-            }
+    ++(p->front);
+    memcpy(p->front, p->buffer, p->bufsize);
 
-            ++pp;
-        }
-    }
+    return true;
 }
 
 /**
-	@brief draw char with given font
+	@brief keep a copy of the display memory and only send bytes that differ from it
 
 	@param p : instance of display
-	@param x : x starting position of char
-	@param y : y starting position of char
-	@param scale : scale font to n times of original size (default should be 1)
-	@param font : pointer to font
-	@param c : character to draw
+	@return bool.
+	@retval true for Success
+	@retval false if the copy could not be allocated
+
 */
-void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c) {
-    if(c<font[3]||c>font[4])
-        return;
+bool ssd1306_enable_shadow(ssd1306_t *p) {
+    if(p->shadow)
+        return true;
 
-    uint32_t parts_per_line=(font[0]>>3)+((font[0]&7)>0);
-    for(uint8_t w=0; w<font[1]; ++w) { // width
-        uint32_t pp=(c-font[3])*font[1]*parts_per_line+w*parts_per_line+5;
-        for(uint32_t lp=0; lp<parts_per_line; ++lp) {
-            uint8_t line=font[pp];
+    // one byte in like the buffer, so both have the same word alignment
+    if((p->shadow=malloc(p->bufsize+1))==NULL)
+        return false;
 
-            for(int8_t j=0; j<8; ++j, line>>=1) {
-                if(line & 1)
-                    ssd1306_draw_square(p, x+w*scale, y+((lp<<3)+j)*scale, scale, scale);
-            }
+    ++(p->shadow);
+    p->shadow_valid=false;
 
-            ++pp;
-        }
-    }
+    return true;
 }
 
 /**
-	@brief clear string with given font
+	@brief swap back and front buffer and display the new front buffer
 
 	@param p : instance of display
-	@param x : x starting position of text
-	@param y : y starting position of text
-	@param scale : scale font to n times of original size (default should be 1)
-	@param font : pointer to font
-	@param s : text to clear
-*/
-void ssd1306_clear_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
-    for(int32_t x_n=x; *s; x_n+=(font[1]+font[2])*scale) {
-        ssd1306_clear_char_with_font(p, x_n, y, scale, font, *(s++));
-    }
-}
 
-/**
-	@brief draw string with given font
+	@return int, see ssd1306_show
 
-	@param p : instance of display
-	@param x : x starting position of text
-	@param y : y starting position of text
-	@param scale : scale font to n times of original size (default should be 1)
-	@param font : pointer to font
-	@param s : text to draw
 */
-void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s) {
-    for(int32_t x_n=x; *s; x_n+=(font[1]+font[2])*scale) {
-        ssd1306_draw_char_with_font(p, x_n, y, scale, font, *(s++));
+int ssd1306_swap(ssd1306_t *p) {
+    if(p->front==NULL||ssd1306_in_band(p))
+        return ssd1306_show(p);
+
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    uint8_t *t=p->buffer;
+    p->buffer=p->front;
+    p->front=t;
+
+    const uint64_t start=ssd1306_frame_begin(p);
+    if(ssd1306_dma_claim(p)&&ssd1306_start_async(p, p->front, 0, p->width-1, 0, p->pages-1)) {
+        ssd1306_shadow_sent(p, p->front, 0, p->width-1, 0, p->pages-1);
+        ssd1306_frame_end(p, start, false);
+    } else {
+        ssd1306_show_diff(p, p->front, 0, p->width-1, 0, p->pages-1);
+        ssd1306_frame_end(p, start, true);
     }
-}
 
-/**
-	@brief clear char with builtin font
+    // the back buffer now holds an older frame than the display does
+    ssd1306_mark_dirty(p, 0, p->width-1, 0, p->pages-1);
 
-	@param p : instance of display
-	@param x : x starting position of char
-	@param y : y starting position of char
-	@param scale : scale font to n times of original size (default should be 1)
-	@param c : character to clear
-*/
-void ssd1306_clear_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
-    ssd1306_clear_char_with_font(p, x, y, scale, font_8x5, c);
+    return ssd1306_take_error(p);
 }
 
 /**
-	@brief draw char with builtin font
+	@brief render the display a band of pages at a time and send each band while the next one renders
 
 	@param p : instance of display
-	@param x : x starting position of char
-	@param y : y starting position of char
-	@param scale : scale font to n times of original size (default should be 1)
-	@param c : character to draw
-*/
-void ssd1306_draw_char(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, char c) {
-    ssd1306_draw_char_with_font(p, x, y, scale, font_8x5, c);
-}
+	@param work : SSD1306_BANDS_SIZE(width, band_pages) bytes
+	@param band_pages : pages per band
+	@param render : called once per band
+	@param arg : passed to render in the band
+	@return int, see ssd1306_show
+	@retval PICO_ERROR_INVALID_ARG if band_pages is 0
+	@retval PICO_ERROR_NOT_PERMITTED if a band is already rendered
 
-/**
-	@brief clear string with builtin font
-
-	@param p : instance of display
-	@param x : x starting position of text
-	@param y : y starting position of text
-	@param scale : scale font to n times of original size (default should be 1)
-	@param s : text to clear
 */
-void ssd1306_clear_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s) {
-    ssd1306_clear_string_with_font(p, x, y, scale, font_8x5, s);
-}
+int ssd1306_show_bands(ssd1306_t *p, uint8_t *work, uint8_t band_pages, void (*render)(ssd1306_t *p, ssd1306_band_t band), void *arg) {
+    if(band_pages==0)
+        return PICO_ERROR_INVALID_ARG;
+    if(ssd1306_in_band(p))
+        return PICO_ERROR_NOT_PERMITTED;
+
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    if(p->start_line)
+        ssd1306_scroll_stop(p);
+
+    // the bands take the place of the buffer, everything else of the display is kept
+    uint8_t *buffer=p->buffer;
+    void (*show_cb)(ssd1306_t *p)=p->show_cb;
+    const uint8_t clip[4]= {p->clip_x0, p->clip_x1, p->clip_y0, p->clip_y1};
+    const uint8_t dirty[4]= {p->dirty_x0, p->dirty_x1, p->dirty_p0, p->dirty_p1};
+    const uint32_t w=p->width, n=band_pages<p->pages?band_pages:p->pages;
+    bool async=ssd1306_dma_claim(p);
+    const uint64_t start=time_us_64();
+    uint64_t rendering=0;
+
+    p->show_cb=NULL;
+
+    for(uint32_t p0=0, i=0; p0<p->pages; p0+=n, ++i) {
+        const uint32_t p1=p0+n<p->pages?p0+n-1:p->pages-1u;
+
+        // the transfer of the band before the previous one is done, so its memory is free
+        uint8_t *band=work+1+(i&1)*(n*w+1);
+        memset(band, 0, (p1-p0+1)*w);
+        p->buffer=band-p0*w;
+        p->band_p0=p0;
+        p->band_p1=p1;
+        ssd1306_clip_band(p);
+
+        if(p->clip_y0<=p->clip_y1) {
+            const uint64_t t=time_us_64();
+            render(p, (ssd1306_band_t) {p0, p1, arg});
+            rendering+=time_us_64()-t;
+        }
 
-/**
-	@brief draw string with builtin font
+        p->band_p0=0xFF;
+        p->band_p1=0;
+        p->clip_x0=clip[0];
+        p->clip_x1=clip[1];
+        p->clip_y0=clip[2];
+        p->clip_y1=clip[3];
+
+        while(ssd1306_is_busy(p))
+            tight_loop_contents();
+
+        if(async&&(async=ssd1306_start_async(p, p->buffer, 0, w-1, p0, p1)))
+            ssd1306_shadow_sent(p, p->buffer, 0, w-1, p0, p1);
+        else if(p->shadow&&!p->shadow_valid) { // the whole frame is sent band by band
+            ssd1306_show_window(p, p->buffer, 0, w-1, p0, p1);
+            ssd1306_shadow_sent(p, p->buffer, 0, w-1, p0, p1);
+        } else
+            ssd1306_show_diff(p, p->buffer, 0, w-1, p0, p1);
+    }
 
-	@param p : instance of display
-	@param x : x starting position of text
-	@param y : y starting position of text
-	@param scale : scale font to n times of original size (default should be 1)
-	@param s : text to draw
-*/
-void ssd1306_draw_string(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const char *s) {
-    ssd1306_draw_string_with_font(p, x, y, scale, font_8x5, s);
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    if(p->shadow)
+        p->shadow_valid=p->error==PICO_OK;
+    p->buffer=buffer;
+    p->show_cb=show_cb;
+    p->dirty_x0=dirty[0];
+    p->dirty_x1=dirty[1];
+    p->dirty_p0=dirty[2];
+    p->dirty_p1=dirty[3];
+
+#ifndef SSD1306_NO_STATS
+    // the render function runs in the frame here, the rest is spent waiting for transfers
+    ++(p->stats.frames);
+    ssd1306_add_duration(&p->stats.render, rendering);
+    p->stats.last_show=time_us_64();
+    ssd1306_add_duration(&p->stats.transfer, p->stats.last_show-start-rendering);
+#else
+    (void) start;
+    (void) rendering;
+#endif
+
+    return ssd1306_take_error(p);
 }
 
 /**
- * @brief retrieve a value from a BMP image header.
+ * @brief start a DMA transfer of the dirty area of a display
  *
- * @param data : pointer to the BMP image data.
- * @param offset : offset of the value in the header.
- * @param size : size of the value (1, 2, or 4 bytes).
- * @return : the retrieved value.
+ * @param p : instance of display
+ * @return bool.
+ * @retval true if a transfer was started
+ * @retval false if nothing is dirty or no DMA channel/memory is available
  */
-static inline uint32_t ssd1306_bmp_get_val(const uint8_t *data, const size_t offset, uint8_t size) {
-    switch(size) {
-    case 1:
-        return data[offset];
-    case 2:
-        return data[offset]|(data[offset+1]<<8);
-    case 4:
-        return data[offset]|(data[offset+1]<<8)|(data[offset+2]<<16)|(data[offset+3]<<24);
-    default:
-        __builtin_unreachable();
-    }
-    __builtin_unreachable();
+static bool ssd1306_dirty_async(ssd1306_t *p) {
+    if(p->dirty_x0>p->dirty_x1||p->dirty_p0>p->dirty_p1||ssd1306_in_band(p)||!ssd1306_dma_claim(p))
+        return false;
+
+    if(p->start_line||(p->shadow&&!p->shadow_valid)) // a moved start line is only reset by a whole frame
+        ssd1306_mark_dirty(p, 0, p->width-1, 0, p->pages-1);
+    if(!ssd1306_start_async(p, p->buffer, p->dirty_x0, p->dirty_x1, p->dirty_p0, p->dirty_p1))
+        return false;
+    ssd1306_frame_end(p, ssd1306_frame_begin(p), false);
+    ssd1306_shadow_sent(p, p->buffer, p->dirty_x0, p->dirty_x1, p->dirty_p0, p->dirty_p1);
+    ssd1306_reset_dirty(p);
+
+    return true;
 }
 
 /**
-	@brief draw monochrome bitmap with offset
+	@brief initialize an empty display group
+
+	@param g : instance of group
 
-	@param p : instance of display
-	@param data : image data (whole file)
-	@param size : size of image data in bytes
-	@param x_offset : offset of horizontal coordinate
-	@param y_offset : offset of vertical coordinate
 */
-void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const long size, uint32_t x_offset, uint32_t y_offset) {
-    if(size<54) // data smaller than header
-        return;
+void ssd1306_group_init(ssd1306_group_t *g) {
+    memset(g, 0, sizeof(*g));
+}
 
-    const uint32_t bfOffBits=ssd1306_bmp_get_val(data, 10, 4);
-    const uint32_t biSize=ssd1306_bmp_get_val(data, 14, 4);
-    const uint32_t biWidth=ssd1306_bmp_get_val(data, 18, 4);
-    const int32_t biHeight=(int32_t) ssd1306_bmp_get_val(data, 22, 4);
-    const uint16_t biBitCount=(uint16_t) ssd1306_bmp_get_val(data, 28, 2);
-    const uint32_t biCompression=ssd1306_bmp_get_val(data, 30, 4);
+/**
+	@brief add an initialized display to a group
 
-    if(biBitCount!=1) // image not monochrome
-        return;
+	@param g : instance of group
+	@param p : instance of display
+	@return bool.
+	@retval true for Success
+	@retval false if the group already holds SSD1306_GROUP_MAX displays
 
-    if(biCompression!=0) // image compressed
-        return;
+*/
+bool ssd1306_group_add(ssd1306_group_t *g, ssd1306_t *p) {
+    if(g->n>=SSD1306_GROUP_MAX)
+        return false;
 
-    const int table_start=14+biSize;
-    uint8_t color_val=0;
+    uint32_t j=0;
+    while(j<g->n&&g->displays[j]->bus!=p->bus)
+        ++j;
 
-    for(uint8_t i=0; i<2; ++i) {
-        if(!((data[table_start+i*4]<<16)|(data[table_start+i*4+1]<<8)|data[table_start+i*4+2])) {
-            color_val=i;
-            break;
-        }
-    }
+    g->bus[g->n]=j<g->n?g->bus[j]:g->buses++;
+    g->displays[g->n++]=p;
+    return true;
+}
 
-    uint32_t bytes_per_line=(biWidth/8)+(biWidth&7?1:0);
-    if(bytes_per_line&3)
-        bytes_per_line=(bytes_per_line^(bytes_per_line&3))+4;
+/**
+	@brief send pending changes of a group without blocking
 
-    const uint8_t *img_data=data+bfOffBits;
+	@param g : instance of group
+	@return bool.
+	@retval true if all changes are sent and both buses are idle
 
-    int32_t step=biHeight>0?-1:1;
-    int32_t border=biHeight>0?-1:-biHeight;
+*/
+bool ssd1306_group_poll(ssd1306_group_t *g) {
+    bool done=true;
+
+    for(uint32_t bus=0; bus<g->buses; ++bus) {
+        if(g->active[bus]) {
+            if(ssd1306_is_busy(g->active[bus])) {
+                done=false;
+                continue;
+            }
+            g->active[bus]=NULL;
+        }
 
-    for(uint32_t y=biHeight>0?biHeight-1:0; y!=(uint32_t)border; y+=step) {
-        for(uint32_t x=0; x<biWidth; ++x) {
-            if(((img_data[x>>3]>>(7-(x&7)))&1)==color_val)
-                ssd1306_draw_pixel(p, x_offset+x, y_offset+y);
+        for(uint32_t i=0; i<g->n; ++i) {
+            const uint32_t j=(g->next[bus]+i)%g->n;
+            ssd1306_t *p=g->displays[j];
+            if(g->bus[j]!=bus||p->dirty_x0>p->dirty_x1||ssd1306_in_band(p))
+                continue;
+
+            g->next[bus]=j+1;
+            if(ssd1306_dirty_async(p))
+                g->active[bus]=p;
+            else
+                ssd1306_show_dirty(p);
+            done=false;
+            break;
         }
-        img_data+=bytes_per_line;
     }
-}
-
-/**
-	@brief draw monochrome bitmap
 
-	@param p : instance of display
-	@param data : image data (whole file)
-	@param size : size of image data in bytes
-*/
-inline void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size) {
-    ssd1306_bmp_show_image_with_offset(p, data, size, 0, 0);
+    return done;
 }
 
 /**
-	@brief display buffer, should be called on change
+	@brief send pending changes of all displays of a group
 
-	@param p : instance of display
+	@param g : instance of group
 
 */
-void ssd1306_show(ssd1306_t *p) {
-    uint8_t payload[]= {SET_COL_ADDR, 0, p->width-1, SET_PAGE_ADDR, 0, p->pages-1};
-    if(p->width==64) {
-        payload[1]+=32;
-        payload[2]+=32;
-    }
-
-    for(size_t i=0; i<sizeof(payload); ++i)
-        ssd1306_write(p, payload[i]);
-
-    *(p->buffer-1)=0x40;
-
-    i2c_write_blocking(p->i2c_i, p->address, p->buffer-1, p->bufsize+1, false);
+void ssd1306_group_show(ssd1306_group_t *g) {
+    while(!ssd1306_group_poll(g))
+        tight_loop_contents();
 }
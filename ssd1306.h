@@ -12,6 +12,50 @@
 #include <pico/stdlib.h>
 #include <hardware/i2c.h>
 
+/**
+*	@brief bytes needed by the buffer of ssd1306_init_with_buffer, one more than the frame for the I2C control byte
+*/
+#define SSD1306_BUFFER_SIZE(width, height) ((width)*((height)/8)+1)
+
+/**
+*	@brief 16 bit words around the frame data in the I2C command stream of asynchronous transfers
+*
+*	control byte, window commands, control byte with restart in front,
+*	control byte with restart and start line command behind
+*/
+#define SSD1306_DMA_OVERHEAD 10
+
+/**
+*	@brief bytes allocated by ssd1306_enable_async for I2C windows of up to band_pages pages, two per display byte
+*/
+#define SSD1306_ASYNC_SIZE(width, band_pages) (((width)*(band_pages)+SSD1306_DMA_OVERHEAD)*2)
+
+/**
+*	@brief bytes needed by the work memory of ssd1306_show_bands, two bands with a control byte each
+*/
+#define SSD1306_BANDS_SIZE(width, band_pages) (2*((width)*(band_pages)+1))
+
+/**
+*	@brief chars sharing an offset in RLE compressed fonts
+*/
+#define SSD1306_RLE_FONT_GROUP 16
+
+/**
+*	@brief version of proportional fonts, their second byte after a 0 where fixed width fonts keep their height
+*/
+#define SSD1306_FONT_V1 1
+
+/**
+*	@brief fixed display geometry
+*
+*	Define both SSD1306_WIDTH and SSD1306_HEIGHT when compiling ssd1306.c to
+*	make the drawing code use constants. Displays of other sizes fail to
+*	initialize then.
+*/
+#if defined(SSD1306_WIDTH)!=defined(SSD1306_HEIGHT)
+#error "define both SSD1306_WIDTH and SSD1306_HEIGHT or neither"
+#endif
+
 /**
 *	@brief defines commands used in ssd1306
 */
@@ -34,24 +78,192 @@ typedef enum {
     SET_DISP_CLK_DIV = 0xD5,
     SET_PRECHARGE = 0xD9,
     SET_VCOM_DESEL = 0xDB,
-    SET_CHARGE_PUMP = 0x8D
+    SET_CHARGE_PUMP = 0x8D,
+    SET_SCROLL_RIGHT = 0x26,
+    SET_SCROLL_LEFT = 0x27,
+    SET_SCROLL_VERT_RIGHT = 0x29,
+    SET_SCROLL_VERT_LEFT = 0x2A,
+    SET_VERT_SCROLL_AREA = 0xA3,
+    SET_SCROLL_OFF = 0x2E,
+    SET_SCROLL_ON = 0x2F
 } ssd1306_command_t;
 
 /**
-*	@brief holds the configuration
+*	@brief operation of the draw functions, change with ssd1306_set_draw_mode
+*/
+typedef enum {
+    SSD1306_DRAW_SET,	/**< set pixels */
+    SSD1306_DRAW_CLEAR,	/**< clear pixels */
+    SSD1306_DRAW_XOR	/**< invert pixels */
+} ssd1306_draw_mode_t;
+
+/**
+*	@brief raster operations of ssd1306_blit
+*/
+typedef enum {
+    SSD1306_ROP_OR,	/**< set pixels set in the sprite */
+    SSD1306_ROP_AND,	/**< clear pixels cleared in the sprite */
+    SSD1306_ROP_XOR,	/**< invert pixels set in the sprite */
+    SSD1306_ROP_COPY	/**< replace pixels with the sprite */
+} ssd1306_rop_t;
+
+/**
+*	@brief sprite in page format
+*/
+typedef struct {
+    uint8_t width;	/**< width of sprite */
+    uint8_t height;	/**< height of sprite */
+    const uint8_t *data;	/**< (height+7)/8 pages of width bytes, top pixel in bit 0 */
+    const uint8_t *mask;	/**< pixels the raster operation applies to, same layout as data, NULL for all */
+} ssd1306_sprite_t;
+
+struct ssd1306;
+struct spi_inst;
+
+/**
+*	@brief number of glyphs a glyph cache can hold at most
+*/
+#define SSD1306_GLYPH_CACHE_MAX 16
+
+/**
+*	@brief glyph held by a glyph cache
+*/
+typedef struct {
+    const uint8_t *font;	/**< font of the glyph */
+    uint8_t c;	/**< character */
+    uint8_t scale;	/**< scale */
+    uint16_t size;	/**< bytes of the bitmap */
+    size_t offset;	/**< position of the bitmap in the pool */
+    uint32_t used;	/**< time of the last use, for evicting the least recently used glyph */
+} ssd1306_glyph_entry_t;
+
+/**
+*	@brief scaled glyphs in page format, see ssd1306_set_glyph_cache
 */
 typedef struct {
+    uint8_t *pool;	/**< bitmaps, packed in the order of the entries */
+    size_t size;	/**< size of pool in bytes */
+    size_t used;	/**< bytes of pool in use */
+    ssd1306_glyph_entry_t entries[SSD1306_GLYPH_CACHE_MAX];	/**< cached glyphs */
+    uint8_t n;	/**< number of cached glyphs */
+    uint32_t clock;	/**< counts the uses of the cache */
+    uint32_t hits;	/**< glyphs found in the cache */
+    uint32_t misses;	/**< glyphs that had to be scaled, including those too large for the pool */
+} ssd1306_glyph_cache_t;
+
+#ifndef SSD1306_NO_STATS
+/**
+*	@brief minimum, average and maximum of a duration in microseconds of time_us_64
+*/
+typedef struct {
+    uint32_t min;	/**< shortest duration */
+    uint32_t avg;	/**< average duration, computed by ssd1306_get_stats */
+    uint32_t max;	/**< longest duration */
+    uint32_t n;	/**< number of durations */
+    uint64_t total;	/**< sum of all durations */
+} ssd1306_duration_t;
+
+/**
+*	@brief counters of a display, define SSD1306_NO_STATS for all files to leave them out
+*/
+typedef struct {
+    uint32_t frames;	/**< frames shown */
+    uint32_t bytes;	/**< commands and display data sent, without I2C control bytes */
+    uint32_t transactions;	/**< transfers of commands or display data */
+    uint32_t nacks;	/**< transfers not acknowledged or aborted */
+    uint32_t timeouts;	/**< transfers timed out */
+    ssd1306_duration_t render;	/**< time from the end of a show to the start of the next one, the time spent in the render function of ssd1306_show_bands */
+    ssd1306_duration_t transfer;	/**< time blocking shows spent sending */
+    uint64_t last_show;	/**< time_us_64 at the end of the last show, 0 before the first one */
+} ssd1306_stats_t;
+#endif
+
+/**
+*	@brief operations connecting the driver to the display
+*/
+typedef struct {
+    void (*write_cmds)(struct ssd1306 *p, const uint8_t *cmds, size_t n);	/**< send commands and their arguments, blocking */
+    void (*write_data)(struct ssd1306 *p, uint8_t *data, size_t n);	/**< send display data, blocking; data[-1] may be changed during the call */
+    size_t (*start_async)(struct ssd1306 *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1);	/**< start sending a window of frame src using p->dma_chan, returns the command and data bytes queued, 0 if not possible */
+    bool (*is_busy)(struct ssd1306 *p);	/**< true while the transfer of start_async runs */
+} ssd1306_transport_t;
+
+/**
+*	@brief holds the configuration
+*/
+typedef struct ssd1306 {
     uint8_t width; 	/**< width of display */
     uint8_t height; 	/**< height of display */
     uint8_t pages;	/**< stores pages of display (calculated on initialization*/
     uint8_t address; 	/**< i2c address of display*/
     i2c_inst_t *i2c_i; 	/**< i2c connection instance */
+    struct spi_inst *spi_i;	/**< spi connection instance, NULL for i2c displays */
+    uint8_t dc_pin;	/**< data/command GPIO of spi displays */
+    uint8_t cs_pin;	/**< chip select GPIO of spi displays */
+    const ssd1306_transport_t *transport;	/**< operations sending to the display */
+    const void *bus;	/**< bus the display is connected to, displays on the same bus are not sent to at the same time */
+    void *pio;	/**< PIO block of pio displays, NULL otherwise */
+    uint8_t pio_sm;	/**< state machine of pio displays */
+    uint8_t pio_offset;	/**< program offset of pio displays */
     bool external_vcc; 	/**< whether display uses external vcc */ 
     uint8_t *buffer;	/**< display buffer */
+    uint8_t *user_buffer;	/**< buffer given to ssd1306_init_with_buffer (one byte in), NULL if allocated */
+    uint8_t *front;	/**< buffer being displayed when double buffering is enabled, NULL otherwise */
+    uint8_t *shadow;	/**< copy of the display memory when enabled with ssd1306_enable_shadow, NULL otherwise */
+    bool shadow_valid;	/**< whether shadow matches the display memory */
     size_t bufsize;	/**< buffer size */
-    uint8_t rotation;	/**< display rotation */
+    uint8_t rotation;	/**< display rotation, change with ssd1306_set_rotation */
+    uint8_t mode;	/**< drawing mode, change with ssd1306_set_draw_mode */
+    void (*draw_pixel_fn)(struct ssd1306 *p, uint32_t x, uint32_t y);	/**< pixel kernel of the current rotation and drawing mode */
+    void (*clear_pixel_fn)(struct ssd1306 *p, uint32_t x, uint32_t y);	/**< clearing pixel kernel of the current rotation */
+    uint8_t clip_x0;	/**< first column drawing may change */
+    uint8_t clip_x1;	/**< last column drawing may change */
+    uint8_t clip_y0;	/**< first buffer row drawing may change */
+    uint8_t clip_y1;	/**< last buffer row drawing may change */
+    uint8_t dirty_x0;	/**< first dirty column (dirty area is empty when dirty_x0>dirty_x1) */
+    uint8_t dirty_x1;	/**< last dirty column */
+    uint8_t dirty_p0;	/**< first dirty page */
+    uint8_t dirty_p1;	/**< last dirty page */
+    uint8_t start_line;	/**< display memory row shown in the first buffer row, moved by ssd1306_scroll_rows */
+    uint8_t band_p0;	/**< first page held by p->buffer while ssd1306_show_bands renders a band, band_p0>band_p1 otherwise */
+    uint8_t band_p1;	/**< last page held by p->buffer while ssd1306_show_bands renders a band */
+    int dma_chan;	/**< DMA channel used by ssd1306_show_async, -1 if none is claimed */
+    uint16_t *dma_buf;	/**< I2C command stream of asynchronous transfers, allocated by ssd1306_enable_async */
+    size_t dma_size;	/**< display bytes dma_buf has room for, 0 if none */
+    void (*show_cb)(struct ssd1306 *p);	/**< called when ssd1306_show_async has queued the whole frame, may be NULL */
+    ssd1306_glyph_cache_t *glyph_cache;	/**< cache of scaled glyphs, NULL if none */
+    int error;	/**< first error of the transfers since the last show, PICO_OK if none */
+#ifndef SSD1306_NO_STATS
+    ssd1306_stats_t stats;	/**< counters, read with ssd1306_get_stats */
+#endif
 } ssd1306_t;
 
+/**
+*	@brief maximum number of displays in a ssd1306_group_t
+*/
+#define SSD1306_GROUP_MAX 8
+
+/**
+*	@brief displays whose updates are scheduled together, see ssd1306_group_show
+*/
+typedef struct {
+    ssd1306_t *displays[SSD1306_GROUP_MAX];	/**< displays of the group */
+    uint8_t n;	/**< number of displays */
+    uint8_t bus[SSD1306_GROUP_MAX];	/**< bus of each display, index into next and active */
+    uint8_t buses;	/**< number of distinct buses */
+    uint8_t next[SSD1306_GROUP_MAX];	/**< display to serve first on each bus (round robin) */
+    ssd1306_t *active[SSD1306_GROUP_MAX];	/**< display sending on each bus, NULL if the bus is idle */
+} ssd1306_group_t;
+
+/**
+*	@brief pages of the display rendered by one call of the render function of ssd1306_show_bands
+*/
+typedef struct {
+    uint8_t p0;	/**< first page */
+    uint8_t p1;	/**< last page */
+    void *arg;	/**< argument given to ssd1306_show_bands */
+} ssd1306_band_t;
+
 /**
 *	@brief initialize display
 *
@@ -63,10 +275,63 @@ typedef struct {
 *	
 * 	@return bool.
 *	@retval true for Success
-*	@retval false if initialization failed
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
 */
 bool ssd1306_init(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance);
 
+/**
+*	@brief initialize display without allocating its buffer
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param address : i2c address of display
+*	@param i2c_instance : instance of i2c connection
+*	@param buffer : SSD1306_BUFFER_SIZE(width, height) bytes, kept by the display until ssd1306_deinit
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64
+*	@note double buffering and the I2C command stream of ssd1306_show_async still allocate when used
+*/
+bool ssd1306_init_with_buffer(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, i2c_inst_t *i2c_instance, uint8_t *buffer);
+
+/**
+*	@brief initialize display connected through a custom transport
+*
+*	@param p : instance of display, with the fields used by the transport set
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param transport : operations sending commands and data
+*	@param buffer : SSD1306_BUFFER_SIZE(width, height) bytes, NULL to allocate them
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
+*/
+bool ssd1306_init_with_transport(ssd1306_t *p, uint16_t width, uint16_t height, const ssd1306_transport_t *transport, uint8_t *buffer);
+
+/**
+	@brief record a failed transfer, for transports detecting missing acknowledges or timeouts
+
+	@param p : instance of display
+	@param error : PICO_ERROR_* code of the transfer
+	@note the error is returned by the next show, see ssd1306_show
+
+*/
+void ssd1306_transfer_error(ssd1306_t *p, int error);
+
+/**
+	@brief write a sequence of commands to the display
+
+	@param p : instance of display
+	@param cmds : commands and their arguments (without the 0x00 control byte)
+	@param n : number of bytes in cmds
+	@note the commands are sent in as few I2C transactions as possible
+
+*/
+void ssd1306_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n);
+
 /**
 *	@brief deinitialize display
 *
@@ -146,18 +411,301 @@ void ssd1306_rotate(ssd1306_t *p, uint8_t val);
 */
 void ssd1306_set_rotation(ssd1306_t *p, uint8_t rotation);
 
+/**
+	@brief set the operation used by the draw functions
+
+	@param p : instance of display
+	@param mode : SSD1306_DRAW_SET, SSD1306_DRAW_CLEAR or SSD1306_DRAW_XOR
+	@note the clear functions always clear, whatever the mode. Sprites and page bitmaps keep their own raster operation.
+
+*/
+void ssd1306_set_draw_mode(ssd1306_t *p, ssd1306_draw_mode_t mode);
+
+/**
+	@brief restrict drawing to a rectangle
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@note all drawing and clearing functions, ssd1306_clear included, leave pixels outside of the rectangle untouched. The rectangle is given in coordinates of the current rotation, ssd1306_set_rotation resets it.
+
+*/
+void ssd1306_set_clip(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
+/**
+	@brief allow drawing on the whole display again
+
+	@param p : instance of display
+
+*/
+void ssd1306_reset_clip(ssd1306_t *p);
+
 /**
 	@brief display buffer, should be called on change
 
 	@param p : instance of display
+	@return int.
+	@retval PICO_OK for Success
+	@retval PICO_ERROR_GENERIC if the display did not acknowledge a transfer since the last show
+	@retval PICO_ERROR_TIMEOUT if a transfer since the last show timed out (I2C with SSD1306_I2C_TIMEOUT_US defined)
+	@retval PICO_ERROR_NOT_PERMITTED if called from the render function of ssd1306_show_bands
+
+*/
+int ssd1306_show(ssd1306_t *p);
+
+/**
+	@brief display only the part of the buffer changed since the last show
+
+	@param p : instance of display
+	@return int, see ssd1306_show
+	@note sends the bounding box of all columns/pages touched since the last call to ssd1306_show or ssd1306_show_dirty; does nothing if nothing changed
+
+*/
+int ssd1306_show_dirty(ssd1306_t *p);
+
+/**
+	@brief display a window of a frame other than the buffer
+
+	@param p : instance of display
+	@param frame : frame laid out like p->buffer, frame[-1] must be writable
+	@param x0 : first column
+	@param x1 : last column
+	@param p0 : first page
+	@param p1 : last page
+	@return int, see ssd1306_show
+	@note the dirty area of p is left untouched; not counted as a frame in the statistics, display lists and the pipeline send through it
+
+*/
+int ssd1306_show_frame(ssd1306_t *p, uint8_t *frame, uint8_t x0, uint8_t x1, uint8_t p0, uint8_t p1);
+
+#ifndef SSD1306_NO_STATS
+/**
+	@brief get the counters of a display
+
+	@param p : instance of display
+	@param stats : set to a copy of p->stats, with the averages computed
+	@note frames are counted by ssd1306_show, ssd1306_show_dirty, ssd1306_show_async, ssd1306_swap, ssd1306_show_bands and ssd1306_group_show; transfers running with DMA are not timed
+
+*/
+void ssd1306_get_stats(ssd1306_t *p, ssd1306_stats_t *stats);
+
+/**
+	@brief reset the counters of a display
+
+	@param p : instance of display
+
+*/
+void ssd1306_reset_stats(ssd1306_t *p);
+#endif
+
+/**
+	@brief scroll the display by moving its start line
+
+	The buffer is moved along, the exposed rows are cleared and only the pages
+	holding them are sent, followed by a single start line command.
+
+	@param p : instance of display
+	@param rows : rows to scroll up, negative to scroll down
+	@note rows are those of the unrotated display, the clip rectangle is ignored. Pending changes are sent first. With double buffering, the back buffer is scrolled. Does nothing in the render function of ssd1306_show_bands.
+
+*/
+void ssd1306_scroll_rows(ssd1306_t *p, int32_t rows);
+
+/**
+	@brief start continuous horizontal scrolling in the display
+
+	@param p : instance of display
+	@param left : true to scroll left, false to scroll right
+	@param start_page : first page to scroll
+	@param end_page : last page to scroll
+	@param interval : frames between steps, 0: 5, 1: 64, 2: 128, 3: 256, 4: 3, 5: 4, 6: 25, 7: 2
+	@note do not send data while the display scrolls, stop it with ssd1306_scroll_stop first
+
+*/
+void ssd1306_scroll_horizontal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval);
+
+/**
+	@brief start continuous diagonal scrolling in the display
+
+	@param p : instance of display
+	@param left : true to scroll left, false to scroll right
+	@param start_page : first page to scroll horizontally
+	@param end_page : last page to scroll horizontally
+	@param interval : frames between steps, see ssd1306_scroll_horizontal
+	@param offset : rows to scroll up per step, 1 to 63
+	@note do not send data while the display scrolls, stop it with ssd1306_scroll_stop first
+
+*/
+void ssd1306_scroll_diagonal(ssd1306_t *p, bool left, uint8_t start_page, uint8_t end_page, uint8_t interval, uint8_t offset);
+
+/**
+	@brief stop hardware scrolling
+
+	@param p : instance of display
+	@note the display memory is out of date afterwards, the whole buffer is sent with the next ssd1306_show_dirty
+
+*/
+void ssd1306_scroll_stop(ssd1306_t *p);
+
+/**
+	@brief prepare a display for asynchronous transfers
+
+	The I2C controller takes 16 bit command words, so the window commands
+	and the display data are copied into a command stream that the DMA
+	feeds to it. The stream is allocated here, SSD1306_ASYNC_SIZE(width,
+	pages) bytes, instead of on the first transfer. Other transports send
+	straight from the frame and need no memory.
+
+	@param p : instance of display
+	@param pages : pages of the largest window to send without blocking, p->pages for whole frames, the band pages for ssd1306_show_bands
+	@return bool.
+	@retval true for Success
+	@retval false if pages is 0 or the stream could not be allocated
+	@note without it, ssd1306_show_async fails and the other functions send blocking on I2C displays. Calling it again with more pages grows the stream.
+
+*/
+bool ssd1306_enable_async(ssd1306_t *p, uint8_t pages);
+
+/**
+	@brief display buffer without blocking, using DMA
+
+	@param p : instance of display
+	@return bool.
+	@retval true if the transfer was started
+	@retval false if a transfer is still running, no DMA channel is available, the I2C command stream of ssd1306_enable_async is missing or too small, or when called from the render function of ssd1306_show_bands
+	@note on I2C the frame is copied into the command stream when the transfer is started, so the buffer may be drawn on right after this call returns. SPI and PIO displays send straight from the buffer: wait until ssd1306_is_busy returns false before drawing, or draw into the back buffer of ssd1306_swap.
+
+*/
+bool ssd1306_show_async(ssd1306_t *p);
+
+/**
+	@brief check whether an asynchronous transfer is still running
+
+	@param p : instance of display
+	@return bool.
+	@retval true while data of ssd1306_show_async is still being sent
+	@note poll this before using the I2C bus for other devices
+
+*/
+bool ssd1306_is_busy(ssd1306_t *p);
+
+/**
+	@brief set callback for asynchronous transfers
+
+	@param p : instance of display
+	@param cb : function called from the DMA interrupt once ssd1306_show_async has handed the last byte to the I2C controller, NULL to disable
 
 */
-void ssd1306_show(ssd1306_t *p);
+void ssd1306_set_show_callback(ssd1306_t *p, void (*cb)(ssd1306_t *p));
+
+/**
+	@brief enable double buffering
+
+	@param p : instance of display
+	@return bool.
+	@retval true for Success
+	@retval false if the second buffer could not be allocated, or when called from the render function of ssd1306_show_bands
+	@note allocates a second buffer; drawing always goes to p->buffer (the back buffer) and ssd1306_swap displays it
+
+*/
+bool ssd1306_enable_double_buffer(ssd1306_t *p);
+
+/**
+	@brief keep a copy of the display memory and only send bytes that differ from it
+
+	@param p : instance of display
+	@return bool.
+	@retval true for Success
+	@retval false if the copy could not be allocated
+	@note the next show sends the whole frame; afterwards ssd1306_show, ssd1306_show_dirty and ssd1306_show_frame only send the runs of changed bytes of each page
+
+*/
+bool ssd1306_enable_shadow(ssd1306_t *p);
+
+/**
+	@brief swap back and front buffer and display the new front buffer
+
+	@param p : instance of display
+	@return int, see ssd1306_show; errors of a transfer started here are returned by the next show or swap
+	@note waits for the previous frame to be sent, then starts sending the new front buffer with DMA (blocking if no DMA channel or, on I2C, no command stream of ssd1306_enable_async is available) and returns; the new back buffer holds the frame before the previous one and should be redrawn completely. Behaves like ssd1306_show without double buffering.
+
+*/
+int ssd1306_swap(ssd1306_t *p);
+
+/**
+	@brief render the display a band of pages at a time and send each band while the next one renders
+
+	Before each call of render, the band is cleared, p->buffer is moved so
+	the pages of the band lie in the work memory and the clip rectangle is
+	narrowed to the band. render draws the whole screen with the usual
+	functions, drawing outside the band is clipped.
+
+	@param p : instance of display
+	@param work : SSD1306_BANDS_SIZE(width, band_pages) bytes
+	@param band_pages : pages per band
+	@param render : called once per band
+	@param arg : passed to render in the band
+	@return int, PICO_OK or the first error of the band transfers and of transfers since the last show, see ssd1306_show
+	@retval PICO_ERROR_INVALID_ARG if band_pages is 0
+	@retval PICO_ERROR_NOT_PERMITTED if called from a render function
+	@note p->buffer is not used, so it can be shared by displays only drawn this way. Bands are sent with DMA when a channel is available (on I2C after ssd1306_enable_async(p, band_pages)), blocking otherwise; the function returns when all are sent. A moved start line is reset first.
+	@note render may only draw: ssd1306_clear, ssd1306_set_clip and ssd1306_reset_clip keep to the band, ssd1306_copy_square and ssd1306_shift only read pages of the band, and the show, swap, scroll_rows, enable_double_buffer and show_bands functions of the display refuse to run.
+
+*/
+int ssd1306_show_bands(ssd1306_t *p, uint8_t *work, uint8_t band_pages, void (*render)(ssd1306_t *p, ssd1306_band_t band), void *arg);
+
+/**
+	@brief initialize an empty display group
+
+	@param g : instance of group
+
+*/
+void ssd1306_group_init(ssd1306_group_t *g);
+
+/**
+	@brief add an initialized display to a group
+
+	@param g : instance of group
+	@param p : instance of display
+	@return bool.
+	@retval true for Success
+	@retval false if the group already holds SSD1306_GROUP_MAX displays
+
+*/
+bool ssd1306_group_add(ssd1306_group_t *g, ssd1306_t *p);
+
+/**
+	@brief send pending changes of a group without blocking
+
+	Starts a DMA transfer of the dirty area on every idle I2C or SPI bus, taking
+	turns among the displays sharing a bus. Call it repeatedly until it returns true.
+
+	@param g : instance of group
+	@return bool.
+	@retval true if all changes are sent and all buses are idle
+	@note displays without a DMA channel, and I2C displays without ssd1306_enable_async, are sent blocking. As with ssd1306_show_async, SPI and PIO displays must not be drawn on while this returns false.
+
+*/
+bool ssd1306_group_poll(ssd1306_group_t *g);
+
+/**
+	@brief send pending changes of all displays of a group
+
+	Transfers on different buses run at the same time, so the group takes about
+	as long as the busiest bus instead of the sum of all displays.
+
+	@param g : instance of group
+
+*/
+void ssd1306_group_show(ssd1306_group_t *g);
 
 /**
 	@brief clear display buffer
 
 	@param p : instance of display
+	@note only the clip rectangle is cleared, see ssd1306_set_clip
 
 */
 void ssd1306_clear(ssd1306_t *p);
@@ -220,6 +768,18 @@ void ssd1306_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width,
 */
 void ssd1306_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
 
+/**
+	@brief invert square at given position with given size
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+	@note inverts the buffer a word at a time, unlike ssd1306_invert, which inverts the display
+*/
+void ssd1306_invert_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height);
+
 /**
 	@brief draw empty square at given position with given size
 
@@ -261,6 +821,42 @@ void ssd1306_draw_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r);
 */
 void ssd1306_draw_empty_circle(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r);
 
+/**
+	@brief draw arc of an empty circle
+
+	@param p : instance of display
+	@param x : x position of the center of the circle
+	@param y : y position of the center of the circle
+	@param r : radius of the circle (same as in ssd1306_draw_empty_circle)
+	@param start : start angle in degrees, 0 is 3 o'clock
+	@param end : end angle in degrees, the arc runs counter-clockwise from start to end; start==end draws the whole circle
+*/
+void ssd1306_draw_arc(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t r, uint32_t start, uint32_t end);
+
+/**
+	@brief draw filled square with rounded corners
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+	@param r : radius of the corners
+*/
+void ssd1306_draw_round_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t r);
+
+/**
+	@brief draw empty square with rounded corners
+
+	@param p : instance of display
+	@param x : x position of starting point
+	@param y : y position of starting point
+	@param width : width of square
+	@param height : height of square
+	@param r : radius of the corners
+*/
+void ssd1306_draw_empty_round_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, uint32_t r);
+
 /**
 	@brief draw monochrome bitmap with offset
 
@@ -281,6 +877,92 @@ void ssd1306_bmp_show_image_with_offset(ssd1306_t *p, const uint8_t *data, const
 */
 void ssd1306_bmp_show_image(ssd1306_t *p, const uint8_t *data, const long size);
 
+/**
+	@brief draw bitmap in page format
+
+	@param p : instance of display
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param bitmap : bitmap in page format (see tools/bmp2page)
+	@note format: width, height, then (height+7)/8 pages of width bytes each, top pixel in bit 0 - the layout of the display buffer
+*/
+void ssd1306_draw_bitmap(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *bitmap);
+
+/**
+	@brief draw a RLE compressed bitmap
+
+	@param p : instance of display
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param bitmap : RLE compressed bitmap (see tools/bmp2rle)
+	@note format: width, height, then the bytes of ssd1306_draw_bitmap compressed: a control byte c<128 is followed by c+1 literal bytes, c>=128 by one byte repeated c-126 times. The bytes are decoded straight into the buffer, pixels are set like ssd1306_draw_bitmap does.
+*/
+void ssd1306_draw_rle_bitmap(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *bitmap);
+
+/**
+	@brief draw char with a RLE compressed font
+
+	@param p : instance of display
+	@param x : x starting position of char
+	@param y : y starting position of char
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to RLE compressed font (see tools/font2rle)
+	@param c : character to draw
+	@note format: the 5 header bytes of a fixed width font, a little endian 16 bit offset per SSD1306_RLE_FONT_GROUP chars counted from the end of the offsets, then the columns of the chars compressed like in ssd1306_draw_rle_bitmap; no run crosses the start of a group
+*/
+void ssd1306_draw_char_with_rle_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c);
+
+/**
+	@brief draw string with a RLE compressed font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to RLE compressed font (see tools/font2rle)
+	@param s : text to draw
+*/
+void ssd1306_draw_string_with_rle_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s);
+
+/**
+	@brief draw sprite with a raster operation
+
+	@param p : instance of display
+	@param sprite : sprite to draw
+	@param x : x position of the upper left corner, may be negative
+	@param y : y position of the upper left corner, may be negative
+	@param rop : raster operation, applied to the pixels set in the mask only
+	@note at rotation 0 sprites are combined with the buffer a byte at a time, using memcpy for page aligned unmasked copies
+*/
+void ssd1306_blit(ssd1306_t *p, const ssd1306_sprite_t *sprite, int32_t x, int32_t y, ssd1306_rop_t rop);
+
+/**
+	@brief copy a rectangle of one display buffer into another one or within one buffer
+
+	@param dst : display to draw into
+	@param x : x position of the upper left corner in dst, may be negative
+	@param y : y position of the upper left corner in dst, may be negative
+	@param src : display to copy from, may be dst
+	@param src_x : x position of the upper left corner in src, may be negative
+	@param src_y : y position of the upper left corner in src, may be negative
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the displays have different rotations
+	@note the pixels are copied whatever the drawing mode, parts outside of src are left out and dst clips as usual; overlapping rectangles within one buffer are moved correctly. Rows are merged a word at a time when source and destination have the same alignment, page aligned rows with memmove. Not for use inside of display lists; in the render function of ssd1306_show_bands only the pages of the band are read, the rest of src counts as outside.
+*/
+bool ssd1306_copy_square(ssd1306_t *dst, int32_t x, int32_t y, const ssd1306_t *src, int32_t src_x, int32_t src_y, uint32_t width, uint32_t height);
+
+/**
+	@brief shift the contents of the clip rectangle
+
+	@param p : instance of display
+	@param dx : pixels to move right, negative to move left
+	@param dy : pixels to move down, negative to move up
+	@note the pixels moved in are cleared; shifting by one pixel a frame gives soft scrolling and slide transitions
+*/
+void ssd1306_shift(ssd1306_t *p, int32_t dx, int32_t dy);
+
 /**
 	@brief clear char with given font
 
@@ -302,9 +984,30 @@ void ssd1306_clear_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t
 	@param scale : scale font to n times of original size (default should be 1)
 	@param font : pointer to font
 	@param c : character to draw
+	@note fixed width fonts start with height, width, spacing, first and last char; proportional fonts (see tools/font2prop) with 0, SSD1306_FONT_V1, height, spacing, first and last char, then last-first+2 little endian 16 bit offsets of the columns of each char counted from the end of the offsets; the width of a char is the distance to the next offset divided by the bytes per column. Proportional fonts of another version draw nothing and have a width of 0
 */
 void ssd1306_draw_char_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, char c);
 
+/**
+	@brief initialize an empty glyph cache
+
+	@param cache : instance of cache
+	@param pool : memory for the bitmaps, kept by the cache
+	@param size : size of pool in bytes, a glyph takes width*scale*pages*scale bytes
+
+*/
+void ssd1306_glyph_cache_init(ssd1306_glyph_cache_t *cache, uint8_t *pool, size_t size);
+
+/**
+	@brief draw scaled text through a glyph cache
+
+	@param p : instance of display
+	@param cache : cache to use, may be shared by displays, NULL to stop using one
+	@note at rotation 0, chars with scale>1 are scaled once into the cache and drawn a byte at a time afterwards; the least recently used glyphs make room for new ones. cache->hits and cache->misses help to size the pool.
+
+*/
+void ssd1306_set_glyph_cache(ssd1306_t *p, ssd1306_glyph_cache_t *cache);
+
 /**
 	@brief clear char with builtin font
 
@@ -351,6 +1054,41 @@ void ssd1306_clear_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32
 */
 void ssd1306_draw_string_with_font(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s );
 
+/**
+	@brief draw at most n chars of a string with given font
+
+	@param p : instance of display
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font
+	@param s : text to draw, may end before n chars with a 0
+	@param n : maximum number of chars to draw
+	@note chars outside of the clip rectangle are skipped before their glyphs are read
+*/
+void ssd1306_draw_text_n(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t scale, const uint8_t *font, const char *s, size_t n);
+
+/**
+	@brief get width of a string
+
+	@param font : pointer to font
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to measure
+	@return width in pixels, without the spacing after the last char
+*/
+uint32_t ssd1306_text_width(const uint8_t *font, uint32_t scale, const char *s);
+
+/**
+	@brief get width of at most n chars of a string
+
+	@param font : pointer to font
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to measure, may end before n chars with a 0
+	@param n : maximum number of chars
+	@return width in pixels, without the spacing after the last char
+*/
+uint32_t ssd1306_text_width_n(const uint8_t *font, uint32_t scale, const char *s, size_t n);
+
 /**
 	@brief clear string with builtin font
 
@@ -0,0 +1,232 @@
+/**
+    @file ssd1306_fixed.h
+    @brief drawing functions specialized for a fixed display geometry and rotation
+    Header only. Width, height and rotation are constants, so the index math
+    reduces to shifts and the page loops unroll.
+    The functions honor the clip rectangle and, where ssd1306.h does, the
+    drawing mode, and keep the dirty area up to date, so they can be mixed
+    with ssd1306.h.
+*/
+
+#ifndef _inc_ssd1306_fixed
+#define _inc_ssd1306_fixed
+#include <string.h>
+#include "ssd1306.h"
+
+/**
+*	@brief extend the dirty area of a display
+*
+*	@param p : instance of display
+*	@param x0 : first column
+*	@param x1 : last column
+*	@param p0 : first page
+*	@param p1 : last page
+*/
+static inline void ssd1306_fixed_dirty(ssd1306_t *p, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    if(x0<p->dirty_x0) p->dirty_x0=x0;
+    if(x1>p->dirty_x1) p->dirty_x1=x1;
+    if(p0<p->dirty_p0) p->dirty_p0=p0;
+    if(p1>p->dirty_p1) p->dirty_p1=p1;
+}
+
+/**
+*	@brief apply a drawing mode to a byte
+*
+*	@param dst : byte to change
+*	@param bits : bits to change
+*	@param mode : SSD1306_DRAW_* operation
+*/
+static inline void ssd1306_fixed_apply(uint8_t *dst, uint8_t bits, ssd1306_draw_mode_t mode) {
+    if(mode==SSD1306_DRAW_SET)
+        *dst|=bits;
+    else if(mode==SSD1306_DRAW_CLEAR)
+        *dst&=~bits;
+    else
+        *dst^=bits;
+}
+
+/**
+*	@brief change bytes of a rectangle given in buffer coordinates, clipped
+*
+*	@param p : instance of display
+*	@param w : width of display
+*	@param pages : pages of display
+*	@param bx0 : first column
+*	@param by0 : first row
+*	@param bx1 : column behind the last one
+*	@param by1 : row behind the last one
+*	@param mode : SSD1306_DRAW_* operation
+*/
+static inline void ssd1306_fixed_fill(ssd1306_t *p, uint32_t w, uint32_t pages, uint32_t bx0, uint32_t by0, uint32_t bx1, uint32_t by1, ssd1306_draw_mode_t mode) {
+    if(bx0<p->clip_x0) bx0=p->clip_x0;
+    if(bx1>p->clip_x1+1u) bx1=p->clip_x1+1u;
+    if(by0<p->clip_y0) by0=p->clip_y0;
+    if(by1>p->clip_y1+1u) by1=p->clip_y1+1u;
+    if(bx0>=bx1||by0>=by1)
+        return;
+
+    _Pragma("GCC unroll 8")
+    for(uint32_t page=0; page<pages; ++page) {
+        if(by1<=page*8||by0>=page*8+8)
+            continue;
+        uint8_t mask=0xFF;
+        if(by0>page*8)
+            mask&=0xFF<<(by0-page*8);
+        if(by1<page*8+8)
+            mask&=0xFF>>(page*8+8-by1);
+        uint8_t *row=p->buffer+page*w;
+        for(uint32_t bx=bx0; bx<bx1; ++bx)
+            ssd1306_fixed_apply(row+bx, mask, mode);
+    }
+    ssd1306_fixed_dirty(p, bx0, bx1-1, by0>>3, (by1-1)>>3);
+}
+
+/**
+*	@brief define the functions of a fixed geometry, all prefixed by name
+*
+*	name##_init(p, address, i2c): ssd1306_init with the geometry, then ssd1306_set_rotation
+*	name##_plot(p, x, y, mode), name##_draw_pixel, name##_clear_pixel, name##_xor_pixel
+*	name##_fill_rect(p, x, y, width, height, mode), name##_draw_square, name##_clear_square
+*	name##_draw_line(p, x1, y1, x2, y2)
+*	name##_draw_char(p, x, y, font, c), name##_clear_char: scale 1, proportional fonts go through ssd1306_draw_char_with_font
+*	name##_clear(p), name##_show(p)
+*
+*	As in ssd1306.h, draw_pixel, draw_square, draw_line and draw_char use the
+*	drawing mode of the display, and everything is clipped, clear included.
+*
+*	@param name : prefix of the functions
+*	@param W : width of display
+*	@param H : height of display, a multiple of 8
+*	@param ROT : rotation, 0 to 3 as in ssd1306_set_rotation
+*/
+#define SSD1306_FIXED_DEFINE(name, W, H, ROT) \
+static inline bool name##_init(ssd1306_t *p, uint8_t address, i2c_inst_t *i2c) { \
+    if(!ssd1306_init(p, (W), (H), address, i2c)) \
+        return false; \
+    ssd1306_set_rotation(p, (ROT)); \
+    return true; \
+} \
+\
+static inline void name##_plot(ssd1306_t *p, uint32_t x, uint32_t y, ssd1306_draw_mode_t mode) { \
+    if(x>=((ROT)&1?(H):(W))||y>=((ROT)&1?(W):(H))) \
+        return; \
+    const uint32_t bx=(ROT)==0?x:(ROT)==1?(W)-1-y:(ROT)==2?(W)-1-x:y; \
+    const uint32_t by=(ROT)==0?y:(ROT)==1?x:(ROT)==2?(H)-1-y:(H)-1-x; \
+    if(bx<p->clip_x0||bx>p->clip_x1||by<p->clip_y0||by>p->clip_y1) \
+        return; \
+    ssd1306_fixed_apply(p->buffer+bx+(by>>3)*(W), 1u<<(by&7), mode); \
+    ssd1306_fixed_dirty(p, bx, bx, by>>3, by>>3); \
+} \
+\
+static inline void name##_draw_pixel(ssd1306_t *p, uint32_t x, uint32_t y) { \
+    name##_plot(p, x, y, (ssd1306_draw_mode_t) p->mode); \
+} \
+\
+static inline void name##_clear_pixel(ssd1306_t *p, uint32_t x, uint32_t y) { \
+    name##_plot(p, x, y, SSD1306_DRAW_CLEAR); \
+} \
+\
+static inline void name##_xor_pixel(ssd1306_t *p, uint32_t x, uint32_t y) { \
+    name##_plot(p, x, y, SSD1306_DRAW_XOR); \
+} \
+\
+static inline void name##_fill_rect(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height, ssd1306_draw_mode_t mode) { \
+    const uint32_t lw=(ROT)&1?(H):(W), lh=(ROT)&1?(W):(H); \
+    if(x>=lw||y>=lh||width==0||height==0) \
+        return; \
+    const uint32_t x1=width>lw-x?lw:x+width, y1=height>lh-y?lh:y+height; \
+    /* half open rectangle in the buffer */ \
+    const uint32_t bx0=(ROT)==0?x:(ROT)==1?(W)-y1:(ROT)==2?(W)-x1:y; \
+    const uint32_t bx1=(ROT)==0?x1:(ROT)==1?(W)-y:(ROT)==2?(W)-x:y1; \
+    const uint32_t by0=(ROT)==0?y:(ROT)==1?x:(ROT)==2?(H)-y1:(H)-x1; \
+    const uint32_t by1=(ROT)==0?y1:(ROT)==1?x1:(ROT)==2?(H)-y:(H)-x; \
+    ssd1306_fixed_fill(p, (W), (H)/8, bx0, by0, bx1, by1, mode); \
+} \
+\
+static inline void name##_draw_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) { \
+    name##_fill_rect(p, x, y, width, height, (ssd1306_draw_mode_t) p->mode); \
+} \
+\
+static inline void name##_clear_square(ssd1306_t *p, uint32_t x, uint32_t y, uint32_t width, uint32_t height) { \
+    name##_fill_rect(p, x, y, width, height, SSD1306_DRAW_CLEAR); \
+} \
+\
+static inline void name##_draw_line(ssd1306_t *p, int32_t x1, int32_t y1, int32_t x2, int32_t y2) { \
+    const ssd1306_draw_mode_t mode=(ssd1306_draw_mode_t) p->mode; \
+    if(y1==y2||x1==x2) { /* one rectangle, cut at the top left edges */ \
+        const int32_t l=x1<x2?x1:x2, r=x1<x2?x2:x1, t=y1<y2?y1:y2, b=y1<y2?y2:y1; \
+        if(r<0||b<0) \
+            return; \
+        name##_fill_rect(p, l<0?0:l, t<0?0:t, r-(l<0?0:l)+1, b-(t<0?0:t)+1, mode); \
+        return; \
+    } \
+    const int32_t dx=x2>x1?x2-x1:x1-x2, sx=x1<x2?1:-1; \
+    const int32_t dy=y2>y1?y1-y2:y2-y1, sy=y1<y2?1:-1; \
+    for(int32_t err=dx+dy;;) { \
+        name##_plot(p, x1, y1, mode); /* negative coordinates wrap around and get dropped */ \
+        if(x1==x2&&y1==y2) \
+            break; \
+        const int32_t e2=2*err; \
+        if(e2>=dy) { \
+            err+=dy; \
+            x1+=sx; \
+        } \
+        if(e2<=dx) { \
+            err+=dx; \
+            y1+=sy; \
+        } \
+    } \
+} \
+\
+static inline void name##_glyph(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *font, char c, ssd1306_draw_mode_t mode) { \
+    if(c<font[3]||c>font[4]) \
+        return; \
+    const uint32_t pages=(font[0]>>3)+((font[0]&7)>0), rows=pages<<3; \
+    const uint8_t *col=font+5+(uint32_t) (c-font[3])*font[1]*pages; \
+    for(uint32_t w=0; w<font[1]; ++w, col+=pages) { \
+        uint32_t run=0; \
+        for(uint32_t j=0; j<=rows; ++j) { \
+            if(j<rows&&(col[j>>3]>>(j&7)&1)) { \
+                ++run; \
+                continue; \
+            } \
+            /* rows above the display are cut off like in ssd1306.h */ \
+            const int32_t top=(int32_t) y+(int32_t) (j-run); \
+            if(run&&top+(int32_t) run>0) \
+                name##_fill_rect(p, x+w, top<0?0:top, 1, top<0?run+top:run, mode); \
+            run=0; \
+        } \
+    } \
+} \
+\
+static inline void name##_draw_char(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *font, char c) { \
+    if(font[0]==0) \
+        ssd1306_draw_char_with_font(p, x, y, 1, font, c); \
+    else \
+        name##_glyph(p, x, y, font, c, (ssd1306_draw_mode_t) p->mode); \
+} \
+\
+static inline void name##_clear_char(ssd1306_t *p, uint32_t x, uint32_t y, const uint8_t *font, char c) { \
+    if(font[0]==0) \
+        ssd1306_clear_char_with_font(p, x, y, 1, font, c); \
+    else \
+        name##_glyph(p, x, y, font, c, SSD1306_DRAW_CLEAR); \
+} \
+\
+static inline void name##_clear(ssd1306_t *p) { \
+    if(p->clip_x0==0&&p->clip_y0==0&&p->clip_x1==(W)-1&&p->clip_y1==(H)-1) { \
+        memset(p->buffer, 0, (W)*((H)/8)); \
+        ssd1306_fixed_dirty(p, 0, (W)-1, 0, (H)/8-1); \
+    } else \
+        ssd1306_fixed_fill(p, (W), (H)/8, 0, 0, (W), (H), SSD1306_DRAW_CLEAR); \
+} \
+\
+static inline void name##_show(ssd1306_t *p) { \
+    ssd1306_show(p); \
+}
+
+SSD1306_FIXED_DEFINE(ssd1306_128x64, 128, 64, 0)
+SSD1306_FIXED_DEFINE(ssd1306_128x32, 128, 32, 0)
+SSD1306_FIXED_DEFINE(ssd1306_64x48, 64, 48, 0)
+
+#endif
@@ -0,0 +1,518 @@
+/**
+    @file ssd1306_list.c
+    @brief display lists: record draw calls, rasterize them page by page when shown
+*/
+#include <pico/stdlib.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306_list.h"
+
+/**
+ * @brief kinds of recorded commands
+ */
+enum ssd1306_list_op {
+    SSD1306_LIST_LINE,
+    SSD1306_LIST_SQUARE,
+    SSD1306_LIST_EMPTY_SQUARE,
+    SSD1306_LIST_CIRCLE,
+    SSD1306_LIST_EMPTY_CIRCLE,
+    SSD1306_LIST_STRING,
+    SSD1306_LIST_BLIT
+};
+
+/**
+ * @brief recorded command, strings follow it in the arena
+ */
+typedef struct {
+    uint8_t op;	/**< ssd1306_list_op */
+    uint8_t mode;	/**< drawing mode at the time of recording */
+    uint8_t pages;	/**< pages the command may change */
+    uint8_t arg;	/**< scale of strings, raster operation of sprites */
+    uint16_t size;	/**< bytes of the command in the arena */
+    int16_t v[4];	/**< coordinates, checked with ssd1306_list_fits */
+    const void *ptr;	/**< font (NULL for the default font) or sprite */
+} ssd1306_list_cmd_t;
+
+/**
+ * @brief round a size up to the alignment of commands
+ */
+#define SSD1306_LIST_ALIGN(n) (((n)+_Alignof(ssd1306_list_cmd_t)-1)&~(_Alignof(ssd1306_list_cmd_t)-1))
+
+/**
+	@brief initialize an empty display list
+
+	@param l : instance of list
+	@param p : display the list is shown on
+	@param arena : memory for the commands, kept by the list
+	@param size : size of arena in bytes
+	@return bool.
+	@retval true for Success
+	@retval false if the display is wider than 128 columns
+
+*/
+bool ssd1306_list_init(ssd1306_list_t *l, ssd1306_t *p, void *arena, size_t size) {
+    if(p->width>sizeof(l->page)-1)
+        return false;
+
+    // commands hold a pointer, so the arena starts aligned
+    const size_t skip=SSD1306_LIST_ALIGN((uintptr_t) arena)-(uintptr_t) arena;
+
+    l->p=p;
+    l->arena=(uint8_t *) arena+(skip<size?skip:size);
+    l->size=skip<size?size-skip:0;
+    l->used=0;
+    l->dirty=0xFF;
+
+    return true;
+}
+
+/**
+	@brief get the position of the end of the list
+
+	@param l : instance of list
+	@return position to pass to ssd1306_list_rewind
+
+*/
+inline size_t ssd1306_list_mark(ssd1306_list_t *l) {
+    return l->used;
+}
+
+/**
+	@brief remove the commands recorded after a position
+
+	@param l : instance of list
+	@param mark : position returned by ssd1306_list_mark, 0 to remove all commands
+
+*/
+void ssd1306_list_rewind(ssd1306_list_t *l, size_t mark) {
+    for(size_t i=mark; i<l->used; i+=((ssd1306_list_cmd_t *) (l->arena+i))->size)
+        l->dirty|=((ssd1306_list_cmd_t *) (l->arena+i))->pages;
+
+    if(mark<l->used)
+        l->used=mark;
+}
+
+/**
+	@brief remove all commands
+
+	@param l : instance of list
+
+*/
+inline void ssd1306_list_clear(ssd1306_list_t *l) {
+    ssd1306_list_rewind(l, 0);
+}
+
+/**
+ * @brief get the pages a rectangle given in display coordinates lies on
+ *
+ * @param p : instance of display
+ * @param x0 : first x position
+ * @param y0 : first y position
+ * @param x1 : last x position
+ * @param y1 : last y position
+ * @return bit mask of the pages, bit 0 is page 0
+ */
+static uint8_t ssd1306_list_pages(ssd1306_t *p, int32_t x0, int32_t y0, int32_t x1, int32_t y1) {
+    const int32_t h=p->height;
+    int32_t r0, r1;
+
+    // buffer rows of the rectangle, see ssd1306_fill_rect
+    switch(p->rotation) {
+    case 0:
+        r0=y0, r1=y1;
+        break;
+    case 1:
+        r0=x0, r1=x1;
+        break;
+    case 2:
+        r0=h-1-y1, r1=h-1-y0;
+        break;
+    default:
+        r0=h-1-x1, r1=h-1-x0;
+        break;
+    }
+
+    if(r0<0)
+        r0=0;
+    if(r1>h-1)
+        r1=h-1;
+    if(r0>r1)
+        return 0;
+
+    return (0xFF<<(r0>>3))&(0xFF>>(7-(r1>>3)));
+}
+
+/**
+ * @brief check that two coordinates fit the 16 bit fields of a command
+ *
+ * @param a : first coordinate
+ * @param b : second coordinate
+ */
+inline static bool ssd1306_list_fits(int32_t a, int32_t b) {
+    return a>=INT16_MIN&&a<=INT16_MAX&&b>=INT16_MIN&&b<=INT16_MAX;
+}
+
+/**
+ * @brief append a command to a list
+ *
+ * Commands that can not change the display are not recorded.
+ *
+ * @param l : instance of list
+ * @param cmd : command, its size field is set here
+ * @param s : string following the command, NULL for none
+ * @return bool.
+ * @retval false if the arena is full
+ */
+static bool ssd1306_list_add(ssd1306_list_t *l, ssd1306_list_cmd_t *cmd, const char *s) {
+    if(cmd->pages==0)
+        return true;
+
+    const size_t n=s?strlen(s)+1:0;
+    const size_t size=SSD1306_LIST_ALIGN(sizeof(*cmd)+n);
+    if(size>UINT16_MAX||size>l->size-l->used)
+        return false;
+
+    cmd->mode=l->p->mode;
+    cmd->size=size;
+    memcpy(l->arena+l->used, cmd, sizeof(*cmd));
+    if(s)
+        memcpy(l->arena+l->used+sizeof(*cmd), s, n);
+
+    l->used+=size;
+    l->dirty|=cmd->pages;
+
+    return true;
+}
+
+/**
+	@brief record a line
+
+	@param l : instance of list
+	@param x1 : x position of starting point
+	@param y1 : y position of starting point
+	@param x2 : x position of end point
+	@param y2 : y position of end point
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_line(ssd1306_list_t *l, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    if(!ssd1306_list_fits(x1, y1)||!ssd1306_list_fits(x2, y2))
+        return false;
+
+    ssd1306_list_cmd_t cmd= {
+        .op=SSD1306_LIST_LINE,
+        .pages=ssd1306_list_pages(l->p, x1<x2?x1:x2, y1<y2?y1:y2, x1<x2?x2:x1, y1<y2?y2:y1),
+        .v={x1, y1, x2, y2},
+    };
+
+    return ssd1306_list_add(l, &cmd, NULL);
+}
+
+/**
+ * @brief record a rectangle
+ *
+ * Like ssd1306_draw_empty_square, outlines reach to x+width and y+height.
+ *
+ * @param l : instance of list
+ * @param op : SSD1306_LIST_SQUARE or SSD1306_LIST_EMPTY_SQUARE
+ * @param x : x position of the upper left corner
+ * @param y : y position of the upper left corner
+ * @param width : width of rectangle
+ * @param height : height of rectangle
+ * @return bool.
+ * @retval false if the arena is full or a coordinate is out of range
+ */
+static bool ssd1306_list_rect(ssd1306_list_t *l, uint8_t op, int32_t x, int32_t y, uint32_t width, uint32_t height) {
+    if(!ssd1306_list_fits(x, y)||width>INT16_MAX||height>INT16_MAX)
+        return false;
+    if(op==SSD1306_LIST_SQUARE&&(width==0||height==0))
+        return true;
+
+    ssd1306_list_cmd_t cmd= {
+        .op=op,
+        .pages=ssd1306_list_pages(l->p, x, y, x+(int32_t) width-(op==SSD1306_LIST_SQUARE), y+(int32_t) height-(op==SSD1306_LIST_SQUARE)),
+        .v={x, y, width, height},
+    };
+
+    return ssd1306_list_add(l, &cmd, NULL);
+}
+
+/**
+	@brief record a filled rectangle
+
+	@param l : instance of list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_square(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t width, uint32_t height) {
+    return ssd1306_list_rect(l, SSD1306_LIST_SQUARE, x, y, width, height);
+}
+
+/**
+	@brief record the outline of a rectangle
+
+	@param l : instance of list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_empty_square(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t width, uint32_t height) {
+    return ssd1306_list_rect(l, SSD1306_LIST_EMPTY_SQUARE, x, y, width, height);
+}
+
+/**
+ * @brief record a circle
+ *
+ * @param l : instance of list
+ * @param op : SSD1306_LIST_CIRCLE or SSD1306_LIST_EMPTY_CIRCLE
+ * @param x : x position of the center
+ * @param y : y position of the center
+ * @param r : radius
+ * @return bool.
+ * @retval false if the arena is full or a coordinate is out of range
+ */
+static bool ssd1306_list_round(ssd1306_list_t *l, uint8_t op, int32_t x, int32_t y, uint32_t r) {
+    if(!ssd1306_list_fits(x, y)||r>INT16_MAX)
+        return false;
+
+    ssd1306_list_cmd_t cmd= {
+        .op=op,
+        .pages=ssd1306_list_pages(l->p, x-(int32_t) r, y-(int32_t) r, x+(int32_t) r, y+(int32_t) r),
+        .v={x, y, r},
+    };
+
+    return ssd1306_list_add(l, &cmd, NULL);
+}
+
+/**
+	@brief record a filled circle
+
+	@param l : instance of list
+	@param x : x position of the center
+	@param y : y position of the center
+	@param r : radius
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_circle(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t r) {
+    return ssd1306_list_round(l, SSD1306_LIST_CIRCLE, x, y, r);
+}
+
+/**
+	@brief record the outline of a circle
+
+	@param l : instance of list
+	@param x : x position of the center
+	@param y : y position of the center
+	@param r : radius
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_empty_circle(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t r) {
+    return ssd1306_list_round(l, SSD1306_LIST_EMPTY_CIRCLE, x, y, r);
+}
+
+/**
+	@brief record a string
+
+	@param l : instance of list
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font, kept by the list
+	@param s : text to draw, copied into the arena
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_string_with_font(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t scale, const uint8_t *font, const char *s) {
+    if(!ssd1306_list_fits(x, y))
+        return false;
+    if(scale==0||scale>UINT8_MAX||*s==0)
+        return true;
+
+    // NULL is the 8x5 font of ssd1306_draw_string, 5 columns and a space
+    const uint8_t font_height=font?(font[0]?font[0]:font[2]):8;
+    const int32_t height=(((font_height>>3)+((font_height&7)>0))<<3)*scale;
+    const int32_t width=font?(int32_t) ssd1306_text_width(font, scale, s):6*(int32_t) scale*(int32_t) strlen(s);
+
+    ssd1306_list_cmd_t cmd= {
+        .op=SSD1306_LIST_STRING,
+        .pages=ssd1306_list_pages(l->p, x, y, x+width-1, y+height-1),
+        .arg=scale,
+        .v={x, y},
+        .ptr=font,
+    };
+
+    return ssd1306_list_add(l, &cmd, s);
+}
+
+/**
+	@brief record a string using the default font
+
+	@param l : instance of list
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to draw, copied into the arena
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+inline bool ssd1306_list_draw_string(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t scale, const char *s) {
+    return ssd1306_list_draw_string_with_font(l, x, y, scale, NULL, s);
+}
+
+/**
+	@brief record a sprite
+
+	@param l : instance of list
+	@param sprite : sprite to draw, kept by the list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param rop : raster operation
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_blit(ssd1306_list_t *l, const ssd1306_sprite_t *sprite, int32_t x, int32_t y, ssd1306_rop_t rop) {
+    if(!ssd1306_list_fits(x, y))
+        return false;
+    if(sprite->width==0||sprite->height==0)
+        return true;
+
+    ssd1306_list_cmd_t cmd= {
+        .op=SSD1306_LIST_BLIT,
+        .pages=ssd1306_list_pages(l->p, x, y, x+sprite->width-1, y+sprite->height-1),
+        .arg=rop,
+        .v={x, y},
+        .ptr=sprite,
+    };
+
+    return ssd1306_list_add(l, &cmd, NULL);
+}
+
+/**
+ * @brief draw a recorded command
+ *
+ * @param p : instance of display
+ * @param cmd : command
+ */
+static void ssd1306_list_draw(ssd1306_t *p, const ssd1306_list_cmd_t *cmd) {
+    const int16_t *v=cmd->v;
+
+    ssd1306_set_draw_mode(p, cmd->mode);
+
+    switch(cmd->op) {
+    case SSD1306_LIST_LINE:
+        ssd1306_draw_line(p, v[0], v[1], v[2], v[3]);
+        break;
+    case SSD1306_LIST_SQUARE:
+        ssd1306_draw_square(p, v[0], v[1], v[2], v[3]);
+        break;
+    case SSD1306_LIST_EMPTY_SQUARE:
+        ssd1306_draw_empty_square(p, v[0], v[1], v[2], v[3]);
+        break;
+    case SSD1306_LIST_CIRCLE:
+        ssd1306_draw_circle(p, v[0], v[1], v[2]);
+        break;
+    case SSD1306_LIST_EMPTY_CIRCLE:
+        ssd1306_draw_empty_circle(p, v[0], v[1], v[2]);
+        break;
+    case SSD1306_LIST_STRING:
+        if(cmd->ptr)
+            ssd1306_draw_string_with_font(p, v[0], v[1], cmd->arg, cmd->ptr, (const char *) (cmd+1));
+        else
+            ssd1306_draw_string(p, v[0], v[1], cmd->arg, (const char *) (cmd+1));
+        break;
+    case SSD1306_LIST_BLIT:
+        ssd1306_blit(p, cmd->ptr, v[0], v[1], cmd->arg);
+        break;
+    }
+}
+
+/**
+	@brief rasterize and send the pages changed since the last show
+
+	@param l : instance of list
+
+	@return int, see ssd1306_show
+
+*/
+int ssd1306_list_show(ssd1306_list_t *l) {
+    ssd1306_t *p=l->p;
+    const uint32_t w=p->width;
+    int error=PICO_OK;
+
+    // p->buffer only holds a band while ssd1306_show_bands renders
+    if(p->band_p0<=p->band_p1)
+        return PICO_ERROR_NOT_PERMITTED;
+
+    if(p->start_line) {
+        ssd1306_scroll_stop(p);
+        l->dirty=0xFF;
+    }
+
+    // drawing goes to the page buffer, everything else of the display is kept
+    uint8_t *buffer=p->buffer, *shadow=p->shadow;
+    const uint8_t mode=p->mode, clip_y0=p->clip_y0, clip_y1=p->clip_y1;
+    const uint8_t dirty[4]= {p->dirty_x0, p->dirty_x1, p->dirty_p0, p->dirty_p1};
+
+    // the shadow would be compared with pages outside the page buffer
+    p->shadow=NULL;
+
+    for(uint32_t page=0; page<p->pages; ++page) {
+        if(!(l->dirty&(1u<<page)))
+            continue;
+
+        memset(l->page+1, 0, w);
+        p->buffer=l->page+1-page*w;
+        p->clip_y0=clip_y0>(page<<3)?clip_y0:page<<3;
+        p->clip_y1=clip_y1<(page<<3)+7?clip_y1:(page<<3)+7;
+
+        if(p->clip_y0<=p->clip_y1) {
+            for(size_t i=0; i<l->used; i+=((ssd1306_list_cmd_t *) (l->arena+i))->size) {
+                const ssd1306_list_cmd_t *cmd=(const ssd1306_list_cmd_t *) (l->arena+i);
+                if(cmd->pages&(1u<<page))
+                    ssd1306_list_draw(p, cmd);
+            }
+        }
+
+        p->clip_y0=clip_y0;
+        p->clip_y1=clip_y1;
+        const int result=ssd1306_show_frame(p, p->buffer, 0, w-1, page, page);
+        if(error==PICO_OK)
+            error=result;
+    }
+
+    p->buffer=buffer;
+    p->shadow=shadow;
+    p->shadow_valid=false;
+    ssd1306_set_draw_mode(p, mode);
+    p->dirty_x0=dirty[0];
+    p->dirty_x1=dirty[1];
+    p->dirty_p0=dirty[2];
+    p->dirty_p1=dirty[3];
+
+    l->dirty=0;
+
+    // errors of earlier transfers are reported even if no page was sent
+    if(error==PICO_OK)
+        error=p->error;
+    p->error=PICO_OK;
+
+    return error;
+}
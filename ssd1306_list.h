@@ -0,0 +1,200 @@
+/**
+    @file ssd1306_list.h
+    @brief display lists: record draw calls, rasterize them page by page when shown
+    Optional, needs no further libraries
+*/
+
+#ifndef _inc_ssd1306_list
+#define _inc_ssd1306_list
+#include "ssd1306.h"
+
+/**
+*	@brief display list of one display
+*
+*	The commands are kept in an arena given by the caller. Showing the list
+*	draws the commands of one page at a time into a page buffer and sends it,
+*	p->buffer is not touched. Displays only drawn through lists can thus share
+*	a single buffer given to ssd1306_init_with_buffer.
+*
+*	Commands keep the drawing mode of the display at the time they are
+*	recorded, the clip rectangle is applied when they are shown. Clear the
+*	list after changing the rotation.
+*
+*	Positions, sizes and radii are stored in 16 bits. Commands with one out
+*	of -32768..32767 (sizes and radii up to 32767) are not recorded, the
+*	record function returns false for them.
+*/
+typedef struct {
+    ssd1306_t *p;	/**< display the list is shown on */
+    uint8_t *arena;	/**< recorded commands */
+    size_t size;	/**< size of arena in bytes */
+    size_t used;	/**< bytes of arena in use */
+    uint8_t dirty;	/**< pages to rasterize with the next ssd1306_list_show, bit 0 is page 0 */
+    uint8_t page[1+128];	/**< page buffer, page[0] is the spare byte in front of the data */
+} ssd1306_list_t;
+
+/**
+	@brief initialize an empty display list
+
+	@param l : instance of list
+	@param p : display the list is shown on
+	@param arena : memory for the commands, kept by the list
+	@param size : size of arena in bytes
+	@return bool.
+	@retval true for Success
+	@retval false if the display is wider than 128 columns
+	@note all pages are rasterized with the first ssd1306_list_show
+
+*/
+bool ssd1306_list_init(ssd1306_list_t *l, ssd1306_t *p, void *arena, size_t size);
+
+/**
+	@brief get the position of the end of the list
+
+	@param l : instance of list
+	@return position to pass to ssd1306_list_rewind
+
+*/
+size_t ssd1306_list_mark(ssd1306_list_t *l);
+
+/**
+	@brief remove the commands recorded after a position
+
+	@param l : instance of list
+	@param mark : position returned by ssd1306_list_mark, 0 to remove all commands
+	@note only the pages touched by the removed commands are rasterized again
+
+*/
+void ssd1306_list_rewind(ssd1306_list_t *l, size_t mark);
+
+/**
+	@brief remove all commands
+
+	@param l : instance of list
+
+*/
+void ssd1306_list_clear(ssd1306_list_t *l);
+
+/**
+	@brief record a line
+
+	@param l : instance of list
+	@param x1 : x position of starting point
+	@param y1 : y position of starting point
+	@param x2 : x position of end point
+	@param y2 : y position of end point
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_line(ssd1306_list_t *l, int32_t x1, int32_t y1, int32_t x2, int32_t y2);
+
+/**
+	@brief record a filled rectangle
+
+	@param l : instance of list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_square(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t width, uint32_t height);
+
+/**
+	@brief record the outline of a rectangle
+
+	@param l : instance of list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param width : width of rectangle
+	@param height : height of rectangle
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_empty_square(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t width, uint32_t height);
+
+/**
+	@brief record a filled circle
+
+	@param l : instance of list
+	@param x : x position of the center
+	@param y : y position of the center
+	@param r : radius
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_circle(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t r);
+
+/**
+	@brief record the outline of a circle
+
+	@param l : instance of list
+	@param x : x position of the center
+	@param y : y position of the center
+	@param r : radius
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_empty_circle(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t r);
+
+/**
+	@brief record a string
+
+	@param l : instance of list
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param font : pointer to font, kept by the list
+	@param s : text to draw, copied into the arena
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_string_with_font(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t scale, const uint8_t *font, const char *s);
+
+/**
+	@brief record a string using the default font
+
+	@param l : instance of list
+	@param x : x starting position of text
+	@param y : y starting position of text
+	@param scale : scale font to n times of original size (default should be 1)
+	@param s : text to draw, copied into the arena
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_draw_string(ssd1306_list_t *l, int32_t x, int32_t y, uint32_t scale, const char *s);
+
+/**
+	@brief record a sprite
+
+	@param l : instance of list
+	@param sprite : sprite to draw, kept by the list
+	@param x : x position of the upper left corner
+	@param y : y position of the upper left corner
+	@param rop : raster operation
+	@return bool.
+	@retval false if the arena is full or a coordinate is out of range
+
+*/
+bool ssd1306_list_blit(ssd1306_list_t *l, const ssd1306_sprite_t *sprite, int32_t x, int32_t y, ssd1306_rop_t rop);
+
+/**
+	@brief rasterize and send the pages changed since the last show
+
+	@param l : instance of list
+	@return int, the first error of the page shows, see ssd1306_show
+	@retval PICO_ERROR_NOT_PERMITTED if called from the render function of ssd1306_show_bands
+	@note a moved start line is reset and all pages are sent. The shadow of ssd1306_enable_shadow is not used and becomes invalid.
+
+*/
+int ssd1306_list_show(ssd1306_list_t *l);
+
+#endif
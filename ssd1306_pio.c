@@ -0,0 +1,513 @@
+/**
+    @file ssd1306_pio.c
+    @brief I2C and SPI connection of SSD1306 displays through a PIO state machine
+*/
+#include <pico/stdlib.h>
+#include <hardware/pio.h>
+#include <hardware/dma.h>
+#include <hardware/clocks.h>
+
+#include "ssd1306_pio.h"
+
+/**
+ * @brief delay of each half of a PIO I2C clock period, in state machine cycles minus one
+ */
+#define SSD1306_PIO_I2C_DELAY 3
+
+/**
+ * @brief PIO I2C master program, write only
+ *
+ * SDA and SCL are driven low by setting their pin direction and released
+ * otherwise. Every transaction is a byte count minus one, followed by the
+ * bytes in the top 8 bits of each FIFO word (a replicated 8 bit write does
+ * that), the address byte first. SDA only changes a delay after SCL went
+ * low. The acknowledge is sampled while SCL is high; a missing one raises
+ * the state machine's relative IRQ 0 and the transaction goes on. The
+ * program waits at its first instruction while idle.
+ */
+static uint16_t ssd1306_pio_i2c_instr[18];
+
+/**
+ * @brief PIO SPI transmitter program, mode 0, MSB first
+ *
+ * Like above, every FIFO word holds one byte in its top 8 bits and the
+ * program waits at its first instruction while idle.
+ */
+static uint16_t ssd1306_pio_spi_instr[4];
+
+/**
+ * @brief assemble the PIO programs
+ */
+static void ssd1306_pio_build(void) {
+    const uint d=SSD1306_PIO_I2C_DELAY;
+    uint16_t *i=ssd1306_pio_i2c_instr;
+
+    // side-set (optional) drives SCL low when 1, each bit is 2/3 low and 1/3 high
+    i[0]=pio_encode_pull(false, true);
+    i[1]=pio_encode_mov(pio_x, pio_osr);
+    i[2]=pio_encode_set(pio_pindirs, 1)|pio_encode_delay(d);                            // start
+    i[3]=pio_encode_pull(false, true)|pio_encode_sideset_opt(1, 1);                       // byte:
+    i[4]=pio_encode_mov_not(pio_osr, pio_osr);
+    i[5]=pio_encode_set(pio_y, 7);
+    i[6]=pio_encode_out(pio_pindirs, 1)|pio_encode_delay(d);                            // bit:
+    i[7]=pio_encode_nop()|pio_encode_sideset_opt(1, 0)|pio_encode_delay(d);
+    i[8]=pio_encode_jmp_y_dec(6)|pio_encode_sideset_opt(1, 1)|pio_encode_delay(d);
+    i[9]=pio_encode_set(pio_pindirs, 0)|pio_encode_delay(d);                            // ack
+    i[10]=pio_encode_nop()|pio_encode_sideset_opt(1, 0)|pio_encode_delay(d);
+    i[11]=pio_encode_jmp_pin(16);
+    i[12]=pio_encode_jmp_x_dec(3)|pio_encode_sideset_opt(1, 1)|pio_encode_delay(d);     // next:
+    i[13]=pio_encode_set(pio_pindirs, 1)|pio_encode_delay(d);                           // stop
+    i[14]=pio_encode_nop()|pio_encode_sideset_opt(1, 0)|pio_encode_delay(d);
+    i[15]=pio_encode_set(pio_pindirs, 0)|pio_encode_delay(d);
+    i[16]=pio_encode_irq_set(true, 0);                                                  // nack:
+    i[17]=pio_encode_jmp(12);
+
+    // side-set drives SCK
+    i=ssd1306_pio_spi_instr;
+    i[0]=pio_encode_pull(false, true)|pio_encode_sideset(1, 0);
+    i[1]=pio_encode_set(pio_x, 7)|pio_encode_sideset(1, 0);
+    i[2]=pio_encode_out(pio_pins, 1)|pio_encode_sideset(1, 0);                            // bit:
+    i[3]=pio_encode_jmp_x_dec(2)|pio_encode_sideset(1, 1);
+}
+
+/**
+ * @brief claim a state machine and load a program for a display
+ *
+ * @param p : instance of display
+ * @param pio : PIO block
+ * @param prog : program to load
+ * @return bool.
+ * @retval false if no state machine or program memory is available
+ */
+static bool ssd1306_pio_claim(ssd1306_t *p, PIO pio, const pio_program_t *prog) {
+    if(ssd1306_pio_i2c_instr[0]==0)
+        ssd1306_pio_build();
+
+    int sm=pio_claim_unused_sm(pio, false);
+    if(sm<0)
+        return false;
+
+    if(!pio_can_add_program(pio, prog)) {
+        pio_sm_unclaim(pio, sm);
+        return false;
+    }
+
+    p->pio=pio;
+    p->pio_sm=sm;
+    p->pio_offset=pio_add_program(pio, prog);
+    p->bus=(const void *) &pio->txf[sm];
+
+    return true;
+}
+
+/**
+ * @brief check whether the state machine has sent everything queued
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true while the FIFO holds data or a byte is being shifted out
+ */
+static bool ssd1306_pio_sm_busy(ssd1306_t *p) {
+    PIO pio=p->pio;
+    return !pio_sm_is_tx_fifo_empty(pio, p->pio_sm)||pio_sm_get_pc(pio, p->pio_sm)!=p->pio_offset;
+}
+
+/**
+ * @brief wait until the state machine has sent everything queued
+ *
+ * The TX stall flag is cleared after the last byte was queued, so it is only
+ * seen again once the state machine waits for new data at its first
+ * instruction.
+ *
+ * @param p : instance of display
+ */
+static void ssd1306_pio_wait(ssd1306_t *p) {
+    PIO pio=p->pio;
+    const uint32_t stall=1u<<(PIO_FDEBUG_TXSTALL_LSB+p->pio_sm);
+
+    pio->fdebug=stall;
+    while(!(pio->fdebug&stall)||ssd1306_pio_sm_busy(p))
+        tight_loop_contents();
+}
+
+/**
+ * @brief queue a byte for the state machine
+ *
+ * @param p : instance of display
+ * @param b : byte to send
+ */
+inline static void ssd1306_pio_put(ssd1306_t *p, uint8_t b) {
+    pio_sm_put_blocking(p->pio, p->pio_sm, (uint32_t) b<<24);
+}
+
+/**
+ * @brief start a DMA transfer feeding whole rows of a frame to the state machine
+ *
+ * @param p : instance of display
+ * @param src : first byte to send
+ * @param n : number of bytes
+ */
+static void ssd1306_pio_dma(ssd1306_t *p, const uint8_t *src, size_t n) {
+    PIO pio=p->pio;
+
+    dma_channel_config c=dma_channel_get_default_config(p->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, p->pio_sm, true));
+
+    dma_channel_configure(p->dma_chan, &c, &pio->txf[p->pio_sm], src, n, true);
+}
+
+/**
+ * @brief build the commands of a window of whole rows
+ *
+ * @param p : instance of display
+ * @param cmds : destination for up to 7 command bytes
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return number of command bytes, including a start line reset if needed
+ */
+static size_t ssd1306_pio_window(ssd1306_t *p, uint8_t *cmds, uint32_t p0, uint32_t p1) {
+    const uint8_t x_offset=p->width==64?32:0;
+    size_t n=0;
+
+    if(p->start_line) {
+        cmds[n++]=SET_DISP_START_LINE;
+        p->start_line=0;
+    }
+    cmds[n++]=SET_COL_ADDR;
+    cmds[n++]=x_offset;
+    cmds[n++]=x_offset+p->width-1;
+    cmds[n++]=SET_PAGE_ADDR;
+    cmds[n++]=p0;
+    cmds[n++]=p1;
+
+    return n;
+}
+
+/**
+ * @brief queue the start of an I2C transaction
+ *
+ * @param p : instance of display
+ * @param control : control byte, 0x00 for commands, 0x40 for data
+ * @param n : number of bytes following the control byte
+ */
+static void ssd1306_pio_i2c_begin(ssd1306_t *p, uint8_t control, size_t n) {
+    pio_sm_put_blocking(p->pio, p->pio_sm, n+1);
+    ssd1306_pio_put(p, p->address<<1);
+    ssd1306_pio_put(p, control);
+}
+
+/**
+ * @brief report a missing acknowledge seen by the state machine
+ *
+ * @param p : instance of display
+ */
+static void ssd1306_pio_i2c_check(ssd1306_t *p) {
+    if(pio_interrupt_get(p->pio, p->pio_sm)) {
+        pio_interrupt_clear(p->pio, p->pio_sm);
+        ssd1306_transfer_error(p, PICO_ERROR_GENERIC);
+    }
+}
+
+/**
+ * @brief send commands over PIO I2C
+ *
+ * @param p : instance of display
+ * @param cmds : commands and their arguments
+ * @param n : number of bytes in cmds
+ */
+static void ssd1306_pio_i2c_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    ssd1306_pio_i2c_begin(p, 0x00, n);
+    while(n--)
+        ssd1306_pio_put(p, *cmds++);
+
+    ssd1306_pio_wait(p);
+    ssd1306_pio_i2c_check(p);
+}
+
+/**
+ * @brief send display data over PIO I2C
+ *
+ * @param p : instance of display
+ * @param data : display data
+ * @param n : number of bytes in data
+ */
+static void ssd1306_pio_i2c_write_data(ssd1306_t *p, uint8_t *data, size_t n) {
+    ssd1306_pio_i2c_begin(p, 0x40, n);
+    while(n--)
+        ssd1306_pio_put(p, *data++);
+
+    ssd1306_pio_wait(p);
+    ssd1306_pio_i2c_check(p);
+}
+
+/**
+ * @brief start a DMA transfer of whole rows of a frame over PIO I2C
+ *
+ * The commands and the transaction start are queued by the CPU, the frame
+ * data is fed to the state machine straight from the frame.
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column (unused)
+ * @param x1 : last column (unused)
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return number of command and data bytes queued, no extra memory is needed
+ */
+static size_t ssd1306_pio_i2c_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    (void) x0;
+    (void) x1;
+
+    uint8_t cmds[7];
+    const size_t m=ssd1306_pio_window(p, cmds, p0, p1);
+    ssd1306_pio_i2c_write_cmds(p, cmds, m);
+
+    const size_t n=(p1-p0+1)*p->width;
+    ssd1306_pio_i2c_begin(p, 0x40, n);
+    ssd1306_pio_dma(p, src+p0*p->width, n);
+
+    return m+n;
+}
+
+/**
+ * @brief check whether the PIO I2C transfer is still running
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true while the DMA channel or the state machine are active
+ * @note a missing acknowledge is reported once the transfer is done
+ */
+static bool ssd1306_pio_i2c_is_busy(ssd1306_t *p) {
+    if(dma_channel_is_busy(p->dma_chan)||ssd1306_pio_sm_busy(p))
+        return true;
+
+    ssd1306_pio_i2c_check(p);
+    return false;
+}
+
+/**
+ * @brief transport of displays set up with ssd1306_init_pio_i2c
+ */
+static const ssd1306_transport_t ssd1306_pio_i2c_transport= {
+    .write_cmds=ssd1306_pio_i2c_write_cmds,
+    .write_data=ssd1306_pio_i2c_write_data,
+    .start_async=ssd1306_pio_i2c_start_async,
+    .is_busy=ssd1306_pio_i2c_is_busy,
+};
+
+/**
+ * @brief send bytes over PIO SPI with D/C set for commands or data
+ *
+ * @param p : instance of display
+ * @param data : true for display data, false for commands
+ * @param src : bytes to send
+ * @param n : number of bytes in src
+ */
+static void ssd1306_pio_spi_write(ssd1306_t *p, bool data, const uint8_t *src, size_t n) {
+    gpio_put(p->dc_pin, data);
+    gpio_put(p->cs_pin, 0);
+    while(n--)
+        ssd1306_pio_put(p, *src++);
+
+    // D/C and CS may only change once the last bit is out
+    ssd1306_pio_wait(p);
+    gpio_put(p->cs_pin, 1);
+}
+
+/**
+ * @brief send commands over PIO SPI
+ *
+ * @param p : instance of display
+ * @param cmds : commands and their arguments
+ * @param n : number of bytes in cmds
+ */
+static void ssd1306_pio_spi_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    ssd1306_pio_spi_write(p, false, cmds, n);
+}
+
+/**
+ * @brief send display data over PIO SPI
+ *
+ * @param p : instance of display
+ * @param data : display data
+ * @param n : number of bytes in data
+ */
+static void ssd1306_pio_spi_write_data(ssd1306_t *p, uint8_t *data, size_t n) {
+    ssd1306_pio_spi_write(p, true, data, n);
+}
+
+/**
+ * @brief start a DMA transfer of whole rows of a frame over PIO SPI
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column (unused)
+ * @param x1 : last column (unused)
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return number of command and data bytes queued, no extra memory is needed
+ */
+static size_t ssd1306_pio_spi_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    (void) x0;
+    (void) x1;
+
+    uint8_t cmds[7];
+    const size_t m=ssd1306_pio_window(p, cmds, p0, p1);
+    ssd1306_pio_spi_write(p, false, cmds, m);
+
+    // CS stays low until ssd1306_pio_spi_is_busy sees the transfer finished
+    gpio_put(p->dc_pin, 1);
+    gpio_put(p->cs_pin, 0);
+
+    const size_t n=(p1-p0+1)*p->width;
+    ssd1306_pio_dma(p, src+p0*p->width, n);
+
+    return m+n;
+}
+
+/**
+ * @brief check whether the PIO SPI transfer is still running
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true while the DMA channel or the state machine are active
+ */
+static bool ssd1306_pio_spi_is_busy(ssd1306_t *p) {
+    if(dma_channel_is_busy(p->dma_chan)||ssd1306_pio_sm_busy(p))
+        return true;
+
+    gpio_put(p->cs_pin, 1);
+    return false;
+}
+
+/**
+ * @brief transport of displays set up with ssd1306_init_pio_spi
+ */
+static const ssd1306_transport_t ssd1306_pio_spi_transport= {
+    .write_cmds=ssd1306_pio_spi_write_cmds,
+    .write_data=ssd1306_pio_spi_write_data,
+    .start_async=ssd1306_pio_spi_start_async,
+    .is_busy=ssd1306_pio_spi_is_busy,
+};
+
+/**
+*	@brief initialize display connected through a write only PIO I2C master
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param address : i2c address of display
+*	@param pio : PIO block to run the state machine on
+*	@param sda_pin : GPIO connected to SDA
+*	@param scl_pin : GPIO connected to SCL
+*	@param baudrate : SCL frequency in Hz
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or no state machine, program memory or buffer is available
+*/
+bool ssd1306_init_pio_i2c(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, PIO pio, uint sda_pin, uint scl_pin, uint32_t baudrate) {
+    const pio_program_t prog= {
+        .instructions=ssd1306_pio_i2c_instr,
+        .length=18,
+        .origin=-1,
+    };
+
+    if(!ssd1306_pio_claim(p, pio, &prog))
+        return false;
+
+    const uint sm=p->pio_sm, offset=p->pio_offset;
+    const uint32_t pins=(1u<<sda_pin)|(1u<<scl_pin);
+
+    // both lines are released (input) at first and driven low by changing only their direction
+    pio_sm_set_pins_with_mask(pio, sm, 0, pins);
+    pio_sm_set_pindirs_with_mask(pio, sm, 0, pins);
+    gpio_pull_up(sda_pin);
+    gpio_pull_up(scl_pin);
+    pio_gpio_init(pio, sda_pin);
+    pio_gpio_init(pio, scl_pin);
+
+    pio_sm_config c=pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset, offset+15);
+    sm_config_set_out_pins(&c, sda_pin, 1);
+    sm_config_set_set_pins(&c, sda_pin, 1);
+    sm_config_set_sideset_pins(&c, scl_pin);
+    sm_config_set_sideset(&c, 2, true, true);
+    sm_config_set_jmp_pin(&c, sda_pin);
+    sm_config_set_out_shift(&c, false, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, (float) clock_get_hz(clk_sys)/(baudrate*3*(SSD1306_PIO_I2C_DELAY+1)));
+
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+
+    p->address=address;
+    p->i2c_i=NULL;
+    p->spi_i=NULL;
+
+    return ssd1306_init_with_transport(p, width, height, &ssd1306_pio_i2c_transport, NULL);
+}
+
+/**
+*	@brief initialize display connected through a PIO SPI transmitter
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param pio : PIO block to run the state machine on
+*	@param mosi_pin : GPIO connected to D1 (MOSI)
+*	@param sck_pin : GPIO connected to D0 (SCK)
+*	@param dc_pin : GPIO connected to D/C of the display
+*	@param cs_pin : GPIO connected to CS of the display
+*	@param baudrate : SCK frequency in Hz
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or no state machine, program memory or buffer is available
+*/
+bool ssd1306_init_pio_spi(ssd1306_t *p, uint16_t width, uint16_t height, PIO pio, uint mosi_pin, uint sck_pin, uint8_t dc_pin, uint8_t cs_pin, uint32_t baudrate) {
+    const pio_program_t prog= {
+        .instructions=ssd1306_pio_spi_instr,
+        .length=4,
+        .origin=-1,
+    };
+
+    if(!ssd1306_pio_claim(p, pio, &prog))
+        return false;
+
+    const uint sm=p->pio_sm, offset=p->pio_offset;
+    const uint32_t pins=(1u<<mosi_pin)|(1u<<sck_pin);
+
+    pio_sm_set_pins_with_mask(pio, sm, 0, pins);
+    pio_sm_set_pindirs_with_mask(pio, sm, pins, pins);
+    pio_gpio_init(pio, mosi_pin);
+    pio_gpio_init(pio, sck_pin);
+
+    pio_sm_config c=pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset, offset+3);
+    sm_config_set_out_pins(&c, mosi_pin, 1);
+    sm_config_set_sideset_pins(&c, sck_pin);
+    sm_config_set_sideset(&c, 1, false, false);
+    sm_config_set_out_shift(&c, false, false, 32);
+    sm_config_set_fifo_join(&c, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&c, (float) clock_get_hz(clk_sys)/(baudrate*2));
+
+    pio_sm_init(pio, sm, offset, &c);
+    pio_sm_set_enabled(pio, sm, true);
+
+    gpio_init(dc_pin);
+    gpio_set_dir(dc_pin, GPIO_OUT);
+    gpio_init(cs_pin);
+    gpio_put(cs_pin, 1);
+    gpio_set_dir(cs_pin, GPIO_OUT);
+
+    p->i2c_i=NULL;
+    p->spi_i=NULL;
+    p->dc_pin=dc_pin;
+    p->cs_pin=cs_pin;
+
+    return ssd1306_init_with_transport(p, width, height, &ssd1306_pio_spi_transport, NULL);
+}
@@ -0,0 +1,56 @@
+/**
+    @file ssd1306_pio.h
+    @brief I2C and SPI connection of SSD1306 displays through a PIO state machine
+    Optional, needs hardware_pio
+*/
+
+#ifndef _inc_ssd1306_pio
+#define _inc_ssd1306_pio
+#include <hardware/pio.h>
+#include "ssd1306.h"
+
+/**
+*	@brief initialize display connected through a write only PIO I2C master
+*
+*	A missing acknowledge is counted and returned by the next show like on
+*	the I2C controller, the rest of the transfer is still clocked out. Clock
+*	stretching is not supported, so clock rates above Fast-mode Plus can be
+*	used as far as the display and the wiring allow.
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param address : i2c address of display
+*	@param pio : PIO block to run the state machine on
+*	@param sda_pin : GPIO connected to SDA
+*	@param scl_pin : GPIO connected to SCL
+*	@param baudrate : SCL frequency in Hz
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or no state machine, program memory or buffer is available
+*	@note the state machine and its program stay claimed after ssd1306_deinit. Missing acknowledges raise the PIO IRQ flag numbered like the state machine.
+*/
+bool ssd1306_init_pio_i2c(ssd1306_t *p, uint16_t width, uint16_t height, uint8_t address, PIO pio, uint sda_pin, uint scl_pin, uint32_t baudrate);
+
+/**
+*	@brief initialize display connected through a PIO SPI transmitter
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param pio : PIO block to run the state machine on
+*	@param mosi_pin : GPIO connected to D1 (MOSI)
+*	@param sck_pin : GPIO connected to D0 (SCK)
+*	@param dc_pin : GPIO connected to D/C of the display
+*	@param cs_pin : GPIO connected to CS of the display
+*	@param baudrate : SCK frequency in Hz
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or no state machine, program memory or buffer is available
+*	@note the state machine and its program stay claimed after ssd1306_deinit
+*/
+bool ssd1306_init_pio_spi(ssd1306_t *p, uint16_t width, uint16_t height, PIO pio, uint mosi_pin, uint sck_pin, uint8_t dc_pin, uint8_t cs_pin, uint32_t baudrate);
+
+#endif
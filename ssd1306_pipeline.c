@@ -0,0 +1,189 @@
+/**
+    @file ssd1306_pipeline.c
+    @brief sending frames of a SSD1306 display from the second core
+*/
+#include <pico/stdlib.h>
+#include <pico/multicore.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ssd1306_pipeline.h"
+
+/**
+ * @brief pipeline served by core 1, NULL while none runs
+ */
+static ssd1306_pipeline_t *ssd1306_pipeline_running;
+
+/**
+ * @brief core 1 loop: receive a frame and its window, send it, return the frame
+ *
+ * The first FIFO word is the pipeline. Each frame then is two FIFO words, the
+ * frame pointer and the window packed as x0 | x1<<8 | p0<<16 | p1<<24, and
+ * goes back as the frame pointer and the result of ssd1306_show_frame. A NULL
+ * frame ends the loop.
+ */
+static void ssd1306_pipeline_core1(void) {
+    ssd1306_pipeline_t *pl=(ssd1306_pipeline_t *) (uintptr_t) multicore_fifo_pop_blocking();
+
+    for(;;) {
+        uint8_t *frame=(uint8_t *) (uintptr_t) multicore_fifo_pop_blocking();
+        if(frame==NULL)
+            break;
+
+        const uint32_t w=multicore_fifo_pop_blocking();
+        const int err=ssd1306_show_frame(pl->p, frame, w&0xFF, (w>>8)&0xFF, (w>>16)&0xFF, w>>24);
+        multicore_fifo_push_blocking((uintptr_t) frame);
+        multicore_fifo_push_blocking((uint32_t) err);
+    }
+
+    // tell core 0 the loop is left
+    multicore_fifo_push_blocking(0);
+}
+
+/**
+ * @brief take one finished frame and its result from core 1
+ *
+ * @param pl : instance of pipeline
+ */
+inline static void ssd1306_pipeline_take(ssd1306_pipeline_t *pl) {
+    pl->spare[pl->spares++]=(uint8_t *) (uintptr_t) multicore_fifo_pop_blocking();
+
+    const int err=(int) multicore_fifo_pop_blocking();
+    if(pl->error==PICO_OK)
+        pl->error=err;
+}
+
+/**
+ * @brief take the frames core 1 has finished
+ *
+ * @param pl : instance of pipeline
+ * @param block : wait for one frame if none is free
+ */
+static void ssd1306_pipeline_reclaim(ssd1306_pipeline_t *pl, bool block) {
+    if(block&&pl->spares==0)
+        ssd1306_pipeline_take(pl);
+
+    while(multicore_fifo_rvalid())
+        ssd1306_pipeline_take(pl);
+}
+
+/**
+	@brief start sending the frames of a display from core 1
+
+	@param pl : instance of pipeline
+	@param p : instance of display
+	@param policy : behaviour of ssd1306_pipeline_submit when both buffers are in use
+	@return bool.
+	@retval true for Success
+	@retval false if a pipeline is already running or the buffers could not be allocated
+
+*/
+bool ssd1306_pipeline_start(ssd1306_pipeline_t *pl, ssd1306_t *p, ssd1306_pipeline_policy_t policy) {
+    if(ssd1306_pipeline_running)
+        return false;
+
+    for(pl->spares=0; pl->spares<2; ++pl->spares) {
+        uint8_t *b=malloc(p->bufsize+1);
+        if(b==NULL) {
+            while(pl->spares)
+                free(pl->spare[--pl->spares]-1);
+            return false;
+        }
+        pl->spare[pl->spares]=b+1;
+    }
+
+    pl->p=p;
+    pl->origin=p->buffer;
+    pl->policy=policy;
+    pl->error=PICO_OK;
+    ssd1306_pipeline_running=pl;
+
+    multicore_fifo_drain();
+    multicore_launch_core1(ssd1306_pipeline_core1);
+    multicore_fifo_push_blocking((uintptr_t) pl);
+
+    return true;
+}
+
+/**
+	@brief hand the changes of the buffer to core 1
+
+	@param pl : instance of pipeline
+	@return bool.
+	@retval true if the frame was queued or nothing was dirty
+	@retval false if the frame was dropped (SSD1306_PIPELINE_DROP only)
+
+*/
+bool ssd1306_pipeline_submit(ssd1306_pipeline_t *pl) {
+    ssd1306_t *p=pl->p;
+
+    if(p->dirty_x0>p->dirty_x1||p->dirty_p0>p->dirty_p1)
+        return true;
+
+    ssd1306_pipeline_reclaim(pl, pl->policy==SSD1306_PIPELINE_BLOCK);
+    if(pl->spares==0)
+        return false;
+
+    uint8_t *frame=p->buffer;
+    p->buffer=pl->spare[--pl->spares];
+    memcpy(p->buffer, frame, p->bufsize);
+
+    // at most two frames are in flight, so neither FIFO fills up
+    multicore_fifo_push_blocking((uintptr_t) frame);
+    multicore_fifo_push_blocking(p->dirty_x0|(p->dirty_x1<<8)|(p->dirty_p0<<16)|((uint32_t) p->dirty_p1<<24));
+    p->dirty_x0=0xFF;
+    p->dirty_x1=0;
+    p->dirty_p0=0xFF;
+    p->dirty_p1=0;
+
+    return true;
+}
+
+/**
+	@brief get and clear the first error of the frames sent by core 1
+
+	@param pl : instance of pipeline
+	@return PICO_OK or the first error since the last call, see ssd1306_show_frame
+
+*/
+int ssd1306_pipeline_error(ssd1306_pipeline_t *pl) {
+    ssd1306_pipeline_reclaim(pl, false);
+
+    const int err=pl->error;
+    pl->error=PICO_OK;
+
+    return err;
+}
+
+/**
+	@brief wait for all queued frames, stop core 1 and free the extra buffers
+
+	@param pl : instance of pipeline
+
+*/
+void ssd1306_pipeline_stop(ssd1306_pipeline_t *pl) {
+    if(ssd1306_pipeline_running!=pl)
+        return;
+
+    ssd1306_t *p=pl->p;
+
+    while(pl->spares<2)
+        ssd1306_pipeline_take(pl);
+
+    multicore_fifo_push_blocking(0);
+    multicore_fifo_pop_blocking();
+    multicore_reset_core1();
+
+    // hand the display its own buffer back, it may not come from malloc
+    if(p->buffer!=pl->origin) {
+        memcpy(pl->origin, p->buffer, p->bufsize);
+        for(uint32_t i=0; i<pl->spares; ++i)
+            if(pl->spare[i]==pl->origin)
+                pl->spare[i]=p->buffer;
+        p->buffer=pl->origin;
+    }
+
+    while(pl->spares)
+        free(pl->spare[--pl->spares]-1);
+    ssd1306_pipeline_running=NULL;
+}
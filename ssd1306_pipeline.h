@@ -0,0 +1,88 @@
+/**
+    @file ssd1306_pipeline.h
+    @brief sending frames of a SSD1306 display from the second core
+    Optional, needs pico_multicore
+*/
+
+#ifndef _inc_ssd1306_pipeline
+#define _inc_ssd1306_pipeline
+#include "ssd1306.h"
+
+/**
+*	@brief what ssd1306_pipeline_submit does while core 1 is still sending
+*/
+typedef enum {
+    SSD1306_PIPELINE_BLOCK,	/**< wait until a buffer is free */
+    SSD1306_PIPELINE_DROP	/**< return at once, the changes go out with the next submitted frame */
+} ssd1306_pipeline_policy_t;
+
+/**
+*	@brief pipeline sending the frames of one display from core 1
+*
+*	The caller owns the instance, it has to stay valid until
+*	ssd1306_pipeline_stop. Core 1 runs one pipeline at a time.
+*/
+typedef struct {
+    ssd1306_t *p;	/**< display whose frames are sent */
+    ssd1306_pipeline_policy_t policy;	/**< behaviour of ssd1306_pipeline_submit when both buffers are in use */
+    uint8_t *origin;	/**< buffer of the display when the pipeline was started */
+    uint8_t *spare[2];	/**< free buffers owned by core 0, besides p->buffer */
+    uint32_t spares;	/**< number of valid entries in spare */
+    int error;	/**< first error of the frames returned by core 1 since the last ssd1306_pipeline_error */
+} ssd1306_pipeline_t;
+
+/**
+	@brief start sending the frames of a display from core 1
+
+	Two more buffers are allocated, so core 0 can draw the next frame while
+	one frame is queued and another one is being sent.
+
+	@param pl : instance of pipeline
+	@param p : instance of display
+	@param policy : behaviour of ssd1306_pipeline_submit when both buffers are in use
+	@return bool.
+	@retval true for Success
+	@retval false if a pipeline is already running or the buffers could not be allocated
+	@note core 1 and the inter-core FIFO are used by the pipeline until ssd1306_pipeline_stop, so only one display can be pipelined at a time. Until then core 1 writes p->error, p->stats and the shadow buffer of p: do not read or reset them from core 0, use ssd1306_pipeline_error instead.
+
+*/
+bool ssd1306_pipeline_start(ssd1306_pipeline_t *pl, ssd1306_t *p, ssd1306_pipeline_policy_t policy);
+
+/**
+	@brief hand the changes of the buffer to core 1
+
+	p->buffer is replaced by a free buffer holding a copy of the submitted frame,
+	so drawing can go on right away.
+
+	@param pl : instance of pipeline
+	@return bool.
+	@retval true if the frame was queued or nothing was dirty
+	@retval false if the frame was dropped (SSD1306_PIPELINE_DROP only)
+	@note do not call the show, swap, scroll or statistics functions of the display while the pipeline runs
+
+*/
+bool ssd1306_pipeline_submit(ssd1306_pipeline_t *pl);
+
+/**
+	@brief get and clear the first error of the frames sent by core 1
+
+	Core 1 returns the result of each frame together with its buffer, so the
+	error is known once ssd1306_pipeline_submit or ssd1306_pipeline_stop has
+	taken the buffer back.
+
+	@param pl : instance of pipeline
+	@return PICO_OK or the first error since the last call, see ssd1306_show_frame
+
+*/
+int ssd1306_pipeline_error(ssd1306_pipeline_t *pl);
+
+/**
+	@brief wait for all queued frames, stop core 1 and free the extra buffers
+
+	@param pl : instance of pipeline
+	@note afterwards p->error, p->stats and the shadow buffer of the display may be used by core 0 again
+
+*/
+void ssd1306_pipeline_stop(ssd1306_pipeline_t *pl);
+
+#endif
@@ -0,0 +1,201 @@
+/**
+    @file ssd1306_sched.c
+    @brief refresh scheduler: coalesce redraws, cap the frame rate, dim and power off idle displays
+*/
+#include <pico/stdlib.h>
+#include <hardware/i2c.h>
+
+#include "ssd1306_sched.h"
+
+/**
+ * @brief time until ssd1306_sched_poll tries again while an async transfer runs
+ */
+#define SSD1306_SCHED_RETRY_US 500
+
+/**
+	@brief initialize a scheduler
+
+	@param s : instance of scheduler
+	@param p : display to schedule
+	@param max_fps : highest frame rate, 0 for no cap
+	@param budget_us : time to wait after the first change for more changes before sending, 0 to send as soon as the cap allows
+
+*/
+void ssd1306_sched_init(ssd1306_sched_t *s, ssd1306_t *p, uint32_t max_fps, uint32_t budget_us) {
+    s->p=p;
+    s->interval_us=max_fps?1000000/max_fps:0;
+    s->budget_us=budget_us;
+    s->dim_after_us=0;
+    s->off_after_us=0;
+    s->contrast=0xFF;
+    s->dim_contrast=0xFF;
+    s->state=SSD1306_SCHED_ACTIVE;
+    s->burst_baudrate=0;
+    s->idle_baudrate=0;
+    s->pending=0;
+    s->last_frame=0;
+    s->last_activity=time_us_64();
+    s->error=PICO_OK;
+}
+
+/**
+	@brief dim and turn off the display when idle
+
+	@param s : instance of scheduler
+	@param contrast : contrast of the active display
+	@param dim_contrast : contrast after dim_after_ms
+	@param dim_after_ms : time without frames or wakes until the contrast is lowered, 0 to never dim
+	@param off_after_ms : time without frames or wakes until the display is turned off, 0 to keep it on
+
+*/
+void ssd1306_sched_set_idle(ssd1306_sched_t *s, uint8_t contrast, uint8_t dim_contrast, uint32_t dim_after_ms, uint32_t off_after_ms) {
+    s->contrast=contrast;
+    s->dim_contrast=dim_contrast;
+    s->dim_after_us=(uint64_t) dim_after_ms*1000;
+    s->off_after_us=(uint64_t) off_after_ms*1000;
+
+    ssd1306_sched_wake(s);
+}
+
+/**
+	@brief raise the I2C baudrate only while frames are sent
+
+	@param s : instance of scheduler
+	@param burst_baudrate : baudrate in Hz while a frame is sent, 0 to leave the baudrate alone
+	@param idle_baudrate : baudrate in Hz set after a frame
+	@return bool.
+	@retval true for Success
+	@retval false if the display is not driven by an I2C controller
+
+*/
+bool ssd1306_sched_set_bus(ssd1306_sched_t *s, uint32_t burst_baudrate, uint32_t idle_baudrate) {
+    if(s->p->i2c_i==NULL)
+        return false;
+
+    s->burst_baudrate=burst_baudrate;
+    s->idle_baudrate=idle_baudrate;
+
+    return true;
+}
+
+/**
+	@brief wake the display up, e.g. on user input
+
+	@param s : instance of scheduler
+
+*/
+void ssd1306_sched_wake(ssd1306_sched_t *s) {
+    s->last_activity=time_us_64();
+
+    if(s->state==SSD1306_SCHED_ACTIVE)
+        return;
+
+    if(s->state==SSD1306_SCHED_OFF)
+        ssd1306_poweron(s->p);
+    ssd1306_contrast(s->p, s->contrast);
+    s->state=SSD1306_SCHED_ACTIVE;
+}
+
+/**
+	@brief send the changes now, ignoring the budget and the frame rate cap
+
+	@param s : instance of scheduler
+	@return PICO_OK or the first I2C error of the frame, see ssd1306_show_dirty
+
+*/
+int ssd1306_sched_flush(ssd1306_sched_t *s) {
+    ssd1306_t *p=s->p;
+
+    if(p->dirty_x0>p->dirty_x1) {
+        s->pending=0;
+        return PICO_OK;
+    }
+
+    s->last_frame=time_us_64();
+    s->pending=0;
+
+    // changing the baudrate turns the controller off, which would cut off a running transfer
+    while(ssd1306_is_busy(p))
+        tight_loop_contents();
+
+    if(s->burst_baudrate)
+        i2c_set_baudrate(p->i2c_i, s->burst_baudrate);
+
+    s->error=ssd1306_show_dirty(p);
+
+    if(s->burst_baudrate)
+        i2c_set_baudrate(p->i2c_i, s->idle_baudrate);
+
+    // a new frame ends the idle time, turned on after sending it so no stale frame shows up
+    ssd1306_sched_wake(s);
+
+    return s->error;
+}
+
+/**
+ * @brief shorten a delay to the time until a deadline
+ *
+ * @param next : delay found so far
+ * @param now : time_us_64
+ * @param due : deadline, not before now
+ */
+inline static uint64_t ssd1306_sched_next(uint64_t next, uint64_t now, uint64_t due) {
+    return due-now<next?due-now:next;
+}
+
+/**
+	@brief send the changes when they are due, dim or turn off the display when idle
+
+	@param s : instance of scheduler
+	@return microseconds until the next frame or idle step is due, UINT32_MAX if there is none; the caller may sleep this long when nothing else changes
+
+*/
+uint32_t ssd1306_sched_poll(ssd1306_sched_t *s) {
+    ssd1306_t *p=s->p;
+    uint64_t now=time_us_64(), next=UINT32_MAX;
+
+    if(p->dirty_x0>p->dirty_x1)
+        s->pending=0;
+    else {
+        if(s->pending==0)
+            s->pending=now;
+
+        // coalesce the changes of the budget, then wait for the cap
+        uint64_t due=s->pending+s->budget_us;
+        if(s->last_frame&&s->last_frame+s->interval_us>due)
+            due=s->last_frame+s->interval_us;
+
+        if(now<due)
+            next=due-now;
+        else if(ssd1306_is_busy(p))
+            next=SSD1306_SCHED_RETRY_US;
+        else {
+            ssd1306_sched_flush(s);
+            now=time_us_64();
+        }
+    }
+
+    // a pending frame lights the display up again anyway
+    if(s->pending)
+        return next;
+
+    if(s->state==SSD1306_SCHED_ACTIVE&&s->dim_after_us) {
+        const uint64_t due=s->last_activity+s->dim_after_us;
+        if(now>=due) {
+            ssd1306_contrast(p, s->dim_contrast);
+            s->state=SSD1306_SCHED_DIMMED;
+        } else
+            next=ssd1306_sched_next(next, now, due);
+    }
+
+    if(s->state!=SSD1306_SCHED_OFF&&s->off_after_us) {
+        const uint64_t due=s->last_activity+s->off_after_us;
+        if(now>=due) {
+            ssd1306_poweroff(p);
+            s->state=SSD1306_SCHED_OFF;
+        } else
+            next=ssd1306_sched_next(next, now, due);
+    }
+
+    return next;
+}
@@ -0,0 +1,119 @@
+/**
+    @file ssd1306_sched.h
+    @brief refresh scheduler: coalesce redraws, cap the frame rate, dim and power off idle displays
+    Optional, needs no further libraries
+*/
+
+#ifndef _inc_ssd1306_sched
+#define _inc_ssd1306_sched
+#include "ssd1306.h"
+
+/**
+*	@brief state of the panel of a scheduled display
+*/
+typedef enum {
+    SSD1306_SCHED_ACTIVE,	/**< on with the normal contrast */
+    SSD1306_SCHED_DIMMED,	/**< on with the idle contrast */
+    SSD1306_SCHED_OFF	/**< turned off with ssd1306_poweroff */
+} ssd1306_sched_state_t;
+
+/**
+*	@brief refresh scheduler of one display
+*
+*	Instead of calling ssd1306_show on a fixed cadence, draw into the buffer
+*	whenever something changes and call ssd1306_sched_poll from the main loop.
+*	The dirty area of the display is the redraw request: it is sent once the
+*	frame budget since the first change has passed and the frame rate cap
+*	allows it, so changes made within the budget go out in one frame. Nothing
+*	is sent while nothing is dirty, and ssd1306_sched_poll tells how long the
+*	caller may sleep.
+*/
+typedef struct {
+    ssd1306_t *p;	/**< display that is scheduled */
+    uint32_t interval_us;	/**< shortest time between two frames, 0 for no cap */
+    uint32_t budget_us;	/**< time from the first change to the frame that sends it */
+    uint64_t dim_after_us;	/**< time without frames or wakes until the contrast is lowered, 0 to never dim */
+    uint64_t off_after_us;	/**< time without frames or wakes until the display is turned off, 0 to keep it on */
+    uint8_t contrast;	/**< contrast of the active display */
+    uint8_t dim_contrast;	/**< contrast of the dimmed display */
+    uint8_t state;	/**< ssd1306_sched_state_t */
+    uint32_t burst_baudrate;	/**< I2C baudrate while a frame is sent, 0 to leave the baudrate alone */
+    uint32_t idle_baudrate;	/**< I2C baudrate restored after a frame */
+    uint64_t pending;	/**< time_us_64 of the first change not sent yet, 0 if none */
+    uint64_t last_frame;	/**< time_us_64 at the start of the last frame */
+    uint64_t last_activity;	/**< time_us_64 of the last frame or wake */
+    int error;	/**< result of the last ssd1306_show_dirty */
+} ssd1306_sched_t;
+
+/**
+	@brief initialize a scheduler
+
+	@param s : instance of scheduler
+	@param p : display to schedule
+	@param max_fps : highest frame rate, 0 for no cap
+	@param budget_us : time to wait after the first change for more changes before sending, 0 to send as soon as the cap allows
+	@note the display is sent to at most every 1/max_fps seconds and changes show up after at most max(budget_us, 1/max_fps). Dimming is off until ssd1306_sched_set_idle.
+
+*/
+void ssd1306_sched_init(ssd1306_sched_t *s, ssd1306_t *p, uint32_t max_fps, uint32_t budget_us);
+
+/**
+	@brief dim and turn off the display when idle
+
+	@param s : instance of scheduler
+	@param contrast : contrast of the active display
+	@param dim_contrast : contrast after dim_after_ms
+	@param dim_after_ms : time without frames or wakes until the contrast is lowered, 0 to never dim
+	@param off_after_ms : time without frames or wakes until the display is turned off, 0 to keep it on
+	@note the next change or ssd1306_sched_wake turns the display on and restores the contrast
+
+*/
+void ssd1306_sched_set_idle(ssd1306_sched_t *s, uint8_t contrast, uint8_t dim_contrast, uint32_t dim_after_ms, uint32_t off_after_ms);
+
+/**
+	@brief raise the I2C baudrate only while frames are sent
+
+	The bus spends less time in transfers at a high SCL rate, other devices
+	on the bus and the time between frames keep the slower idle rate.
+
+	@param s : instance of scheduler
+	@param burst_baudrate : baudrate in Hz while a frame is sent, 0 to leave the baudrate alone
+	@param idle_baudrate : baudrate in Hz set after a frame
+	@return bool.
+	@retval true for Success
+	@retval false if the display is not driven by an I2C controller
+	@note the SSD1306 is specified for 400 kHz, many modules work at 1 MHz. The I2C controller is turned off while its baudrate changes: ssd1306_sched_flush waits for the transfers of s->p, but no other display or device on the same bus (e.g. of a ssd1306_group_t) may be transferring while a frame is flushed.
+
+*/
+bool ssd1306_sched_set_bus(ssd1306_sched_t *s, uint32_t burst_baudrate, uint32_t idle_baudrate);
+
+/**
+	@brief wake the display up, e.g. on user input
+
+	@param s : instance of scheduler
+	@note turns the display on, restores the contrast and starts the idle times again
+
+*/
+void ssd1306_sched_wake(ssd1306_sched_t *s);
+
+/**
+	@brief send the changes now, ignoring the budget and the frame rate cap
+
+	@param s : instance of scheduler
+	@return PICO_OK or the first I2C error of the frame, see ssd1306_show_dirty
+	@note waits for a running transfer of ssd1306_show_async or ssd1306_swap first
+
+*/
+int ssd1306_sched_flush(ssd1306_sched_t *s);
+
+/**
+	@brief send the changes when they are due, dim or turn off the display when idle
+
+	@param s : instance of scheduler
+	@return microseconds until the next frame or idle step is due, UINT32_MAX if there is none; the caller may sleep this long when nothing else changes
+	@note the result of a sent frame is kept in s->error. Nothing is sent while a transfer of ssd1306_show_async is running.
+
+*/
+uint32_t ssd1306_sched_poll(ssd1306_sched_t *s);
+
+#endif
@@ -0,0 +1,154 @@
+/**
+    @file ssd1306_spi.c
+    @brief 4-wire SPI connection of SSD1306 displays
+*/
+#include <pico/stdlib.h>
+#include <hardware/spi.h>
+#include <hardware/dma.h>
+
+#include "ssd1306_spi.h"
+
+/**
+ * @brief send bytes with D/C set for commands or data
+ *
+ * @param p : instance of display
+ * @param data : true for display data, false for commands
+ * @param src : bytes to send
+ * @param n : number of bytes in src
+ */
+static void ssd1306_spi_write(ssd1306_t *p, bool data, const uint8_t *src, size_t n) {
+    gpio_put(p->dc_pin, data);
+    gpio_put(p->cs_pin, 0);
+    spi_write_blocking(p->spi_i, src, n);
+    gpio_put(p->cs_pin, 1);
+}
+
+/**
+ * @brief send commands over SPI
+ *
+ * @param p : instance of display
+ * @param cmds : commands and their arguments
+ * @param n : number of bytes in cmds
+ */
+static void ssd1306_spi_write_cmds(ssd1306_t *p, const uint8_t *cmds, size_t n) {
+    ssd1306_spi_write(p, false, cmds, n);
+}
+
+/**
+ * @brief send display data over SPI
+ *
+ * @param p : instance of display
+ * @param data : display data
+ * @param n : number of bytes in data
+ */
+static void ssd1306_spi_write_data(ssd1306_t *p, uint8_t *data, size_t n) {
+    ssd1306_spi_write(p, true, data, n);
+}
+
+/**
+ * @brief start a DMA transfer of whole rows of a frame
+ *
+ * Unlike I2C, SPI takes the bytes straight from the frame. Rows are
+ * contiguous there, so the window is widened to whole rows. A moved start
+ * line is reset in front of the data, so the window has to cover the whole
+ * frame then.
+ *
+ * @param p : instance of display
+ * @param src : frame to send
+ * @param x0 : first column (unused)
+ * @param x1 : last column (unused)
+ * @param p0 : first page
+ * @param p1 : last page
+ * @return number of command and data bytes queued, SPI needs no extra memory
+ */
+static size_t ssd1306_spi_start_async(ssd1306_t *p, const uint8_t *src, uint32_t x0, uint32_t x1, uint32_t p0, uint32_t p1) {
+    (void) x0;
+    (void) x1;
+
+    const uint8_t x_offset=p->width==64?32:0;
+    uint8_t cmds[7];
+    size_t n=0;
+
+    if(p->start_line) {
+        cmds[n++]=SET_DISP_START_LINE;
+        p->start_line=0;
+    }
+    cmds[n++]=SET_COL_ADDR;
+    cmds[n++]=x_offset;
+    cmds[n++]=x_offset+p->width-1;
+    cmds[n++]=SET_PAGE_ADDR;
+    cmds[n++]=p0;
+    cmds[n++]=p1;
+    ssd1306_spi_write(p, false, cmds, n);
+
+    // CS stays low until ssd1306_spi_is_busy sees the transfer finished
+    gpio_put(p->dc_pin, 1);
+    gpio_put(p->cs_pin, 0);
+
+    dma_channel_config c=dma_channel_get_default_config(p->dma_chan);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, spi_get_dreq(p->spi_i, true));
+
+    const size_t size=(p1-p0+1)*p->width;
+    dma_channel_configure(p->dma_chan, &c, &spi_get_hw(p->spi_i)->dr, src+p0*p->width, size, true);
+
+    return n+size;
+}
+
+/**
+ * @brief check whether the SPI controller is still sending the frame
+ *
+ * @param p : instance of display
+ * @return bool.
+ * @retval true while the DMA channel or the controller are active
+ */
+static bool ssd1306_spi_is_busy(ssd1306_t *p) {
+    if(dma_channel_is_busy(p->dma_chan)||spi_is_busy(p->spi_i))
+        return true;
+
+    gpio_put(p->cs_pin, 1);
+    return false;
+}
+
+/**
+ * @brief transport of displays set up with ssd1306_init_spi
+ */
+static const ssd1306_transport_t ssd1306_spi_transport= {
+    .write_cmds=ssd1306_spi_write_cmds,
+    .write_data=ssd1306_spi_write_data,
+    .start_async=ssd1306_spi_start_async,
+    .is_busy=ssd1306_spi_is_busy,
+};
+
+/**
+*	@brief initialize display connected through SPI
+*
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param spi : instance of spi connection
+*	@param dc_pin : GPIO connected to D/C of the display
+*	@param cs_pin : GPIO connected to CS of the display
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
+*/
+bool ssd1306_init_spi(ssd1306_t *p, uint16_t width, uint16_t height, spi_inst_t *spi, uint8_t dc_pin, uint8_t cs_pin) {
+    p->i2c_i=NULL;
+    p->spi_i=spi;
+    p->pio=NULL;
+    p->bus=spi;
+    p->dc_pin=dc_pin;
+    p->cs_pin=cs_pin;
+
+    gpio_init(dc_pin);
+    gpio_set_dir(dc_pin, GPIO_OUT);
+    gpio_init(cs_pin);
+    gpio_put(cs_pin, 1);
+    gpio_set_dir(cs_pin, GPIO_OUT);
+
+    return ssd1306_init_with_transport(p, width, height, &ssd1306_spi_transport, NULL);
+}
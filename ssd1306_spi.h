@@ -0,0 +1,30 @@
+/**
+    @file ssd1306_spi.h
+    @brief 4-wire SPI connection of SSD1306 displays
+    Optional, needs hardware_spi
+*/
+
+#ifndef _inc_ssd1306_spi
+#define _inc_ssd1306_spi
+#include <hardware/spi.h>
+#include "ssd1306.h"
+
+/**
+*	@brief initialize display connected through SPI
+*
+*	spi has to be initialized and its SCK and TX pins set up before, the RES
+*	pin of the display, if any, has to be released.
+*	@param p : instance of display
+*	@param width : width of display
+*	@param height : heigth of display
+*	@param spi : instance of spi connection
+*	@param dc_pin : GPIO connected to D/C of the display
+*	@param cs_pin : GPIO connected to CS of the display
+*
+* 	@return bool.
+*	@retval true for Success
+*	@retval false if the display is larger than 128x64 or its buffer could not be allocated
+*/
+bool ssd1306_init_spi(ssd1306_t *p, uint16_t width, uint16_t height, spi_inst_t *spi, uint8_t dc_pin, uint8_t cs_pin);
+
+#endif
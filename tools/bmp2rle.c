@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Converts a monochrome BMP into the format of ssd1306_draw_rle_bitmap:
+ * <width>, <height>, then the (height+7)/8 pages of <width> bytes of
+ * ssd1306_draw_bitmap, run length encoded. A control byte c<128 is followed
+ * by c+1 literal bytes, c>=128 by one byte repeated c-126 times.
+ * Like ssd1306_bmp_show_image, black pixels are drawn.
+ */
+
+void normalize_name(char *name) {
+    for(size_t i=0; name[i]!=0;) {
+        if('a'<=name[i]&&name[i]<='z')
+            goto next;
+        else if('A'<=name[i]&&name[i]<='Z')
+            goto next;
+        else if('0'<=name[i]&&name[i]<='9')
+            goto next;
+        else
+            name[i]='_';
+next:
+        ++i;
+    }
+}
+
+uint32_t get_val(const uint8_t *data, size_t offset, uint8_t size) {
+    uint32_t val=0;
+    for(uint8_t i=0; i<size; ++i)
+        val|=(uint32_t) data[offset+i]<<(i*8);
+    return val;
+}
+
+size_t rle_encode(const uint8_t *in, size_t n, uint8_t *out) {
+    size_t o=0;
+
+    for(size_t i=0; i<n;) {
+        size_t run=1;
+        while(i+run<n&&run<129&&in[i+run]==in[i])
+            ++run;
+
+        if(run>=2) {
+            out[o++]=126+run;
+            out[o++]=in[i];
+            i+=run;
+            continue;
+        }
+
+        // a run of two costs as much as two literals, only longer ones end the literals
+        const size_t start=i;
+        while(i<n&&i-start<128&&!(i+2<n&&in[i]==in[i+1]&&in[i]==in[i+2]))
+            ++i;
+        out[o++]=i-start-1;
+        memcpy(out+o, in+start, i-start);
+        o+=i-start;
+    }
+
+    return o;
+}
+
+uint8_t *read_file(FILE *in, size_t *size) {
+    fseek(in, 0, SEEK_END);
+    *size=ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    uint8_t *data=malloc(*size);
+    if(data==NULL)
+        return NULL;
+
+    if(fread(data, 1, *size, in)!=*size) {
+        free(data);
+        return NULL;
+    }
+
+    return data;
+}
+
+int convert_to_rle(const char *name, const uint8_t *data, size_t size, FILE *out) {
+    if(size<54) {
+        fprintf(stderr, "File is too small for a BMP!\n");
+        return -1;
+    }
+
+    const uint32_t bfOffBits=get_val(data, 10, 4);
+    const uint32_t biSize=get_val(data, 14, 4);
+    const uint32_t biWidth=get_val(data, 18, 4);
+    const int32_t biHeight=(int32_t) get_val(data, 22, 4);
+    const uint16_t biBitCount=(uint16_t) get_val(data, 28, 2);
+    const uint32_t biCompression=get_val(data, 30, 4);
+    const uint32_t height=biHeight>0?biHeight:-biHeight;
+
+    if(biBitCount!=1||biCompression!=0) {
+        fprintf(stderr, "Only uncompressed monochrome BMPs are supported!\n");
+        return -1;
+    }
+
+    if(biWidth==0||biWidth>255||height==0||height>255) {
+        fprintf(stderr, "Width and height must be between 1 and 255!\n");
+        return -1;
+    }
+
+    const size_t table_start=14+biSize;
+    uint8_t color_val=0;
+    for(uint8_t i=0; i<2; ++i) {
+        if(!((data[table_start+i*4]<<16)|(data[table_start+i*4+1]<<8)|data[table_start+i*4+2])) {
+            color_val=i;
+            break;
+        }
+    }
+
+    uint32_t bytes_per_line=(biWidth/8)+(biWidth&7?1:0);
+    if(bytes_per_line&3)
+        bytes_per_line=(bytes_per_line^(bytes_per_line&3))+4;
+
+    if(bfOffBits+(size_t) bytes_per_line*height>size) {
+        fprintf(stderr, "Image data is truncated!\n");
+        return -1;
+    }
+
+    const uint32_t pages=(height+7)/8;
+    const size_t n=(size_t) pages*biWidth;
+    uint8_t *page_data=calloc(n, 1), *rle=malloc(n+n/128+1);
+    if(page_data==NULL||rle==NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        free(page_data);
+        free(rle);
+        return -1;
+    }
+
+    for(uint32_t page=0; page<pages; ++page) {
+        for(uint32_t x=0; x<biWidth; ++x) {
+            uint8_t b=0;
+            for(uint32_t j=0; j<8&&page*8+j<height; ++j) {
+                const uint32_t y=page*8+j;
+                const uint8_t *row=data+bfOffBits+(biHeight>0?height-1-y:y)*bytes_per_line;
+                if(((row[x>>3]>>(7-(x&7)))&1)==color_val)
+                    b|=1<<j;
+            }
+            page_data[page*biWidth+x]=b;
+        }
+    }
+
+    const size_t rle_size=rle_encode(page_data, n, rle);
+    fprintf(out, "// %zu bytes uncompressed\nconst uint8_t %s[]={\n%u, %u,\n", n+2, name, biWidth, height);
+    for(size_t i=0; i<rle_size; ++i)
+        fprintf(out, i+1<rle_size?"0x%02x,%s":"0x%02x\n", rle[i], (i&15)==15?"\n":"");
+    fprintf(out, "};\n");
+
+    free(page_data);
+    free(rle);
+
+    return 0;
+}
+
+int main(int ac, char *as[]) {
+    if(ac<2||ac>3) {
+        fprintf(stderr, "Usage: %s [input bmp] [output file?]\n", as[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in=NULL, *out=NULL;
+    uint8_t *data=NULL;
+    size_t size;
+
+    if((in=fopen(as[1], "rb"))==NULL) {
+        fprintf(stderr, "Could not open \"%s\" for reading!\n", as[1]);
+        goto fail;
+    }
+
+    if((data=read_file(in, &size))==NULL) {
+        fprintf(stderr, "Could not read \"%s\"!\n", as[1]);
+        goto fail;
+    }
+
+    if(ac==3) {
+        if((out=fopen(as[2], "w"))==NULL) {
+            fprintf(stderr, "Could not open \"%s\" for writing!\n", as[2]);
+            goto fail;
+        }
+    } else
+        out=stdout;
+
+    char *norm_name=strdup(as[1]);
+    normalize_name(norm_name);
+
+    int res=convert_to_rle(norm_name, data, size, out);
+
+    free(norm_name);
+    free(data);
+
+    fclose(in);
+    fclose(out);
+
+    return res?EXIT_FAILURE:EXIT_SUCCESS;
+
+fail:
+    free(data);
+    if(in)
+        fclose(in);
+    if(out)
+        fclose(out);
+    return EXIT_FAILURE;
+}
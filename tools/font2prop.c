@@ -0,0 +1,222 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+ * Converts a fixed width font header like font.h into a proportional font
+ * of format SSD1306_FONT_V1: 0, 1, <height>, <spacing>, <first>, <last>,
+ * a little endian 16 bit offset per char plus one for the end, counted from
+ * the end of the offsets, then the <width>*<pages> column bytes of each
+ * char. Empty columns left and right of each char are dropped, empty chars
+ * like the space keep half the width of the font.
+ */
+
+char *read_file(FILE *in) {
+    fseek(in, 0, SEEK_END);
+    const size_t size=ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    char *data=malloc(size+1);
+    if(data==NULL)
+        return NULL;
+
+    if(fread(data, 1, size, in)!=size) {
+        free(data);
+        return NULL;
+    }
+    data[size]=0;
+
+    return data;
+}
+
+/*
+ * Blanks out comments, they may contain braces and digits.
+ */
+void strip_comments(char *s) {
+    for(; *s; ++s) {
+        if(s[0]=='/'&&s[1]=='/') {
+            for(; *s&&*s!='\n'; ++s)
+                *s=' ';
+            if(*s==0)
+                break;
+        } else if(s[0]=='/'&&s[1]=='*') {
+            for(; *s&&!(s[0]=='*'&&s[1]=='/'); ++s)
+                *s=' ';
+            if(*s==0)
+                break;
+            s[0]=s[1]=' ';
+        }
+    }
+}
+
+/*
+ * Reads the name and the values of the first array initializer.
+ */
+uint8_t *parse_array(char *src, char *name, size_t name_size, size_t *size) {
+    char *open=strchr(src, '{'), *bracket=strchr(src, '[');
+    if(open==NULL||bracket==NULL||bracket>open)
+        return NULL;
+
+    char *end=bracket;
+    while(end>src&&isspace((unsigned char) end[-1]))
+        --end;
+    char *begin=end;
+    while(begin>src&&(isalnum((unsigned char) begin[-1])||begin[-1]=='_'))
+        --begin;
+    if(begin==end||(size_t) (end-begin)>=name_size)
+        return NULL;
+    memcpy(name, begin, end-begin);
+    name[end-begin]=0;
+
+    uint8_t *values=malloc(strlen(open));
+    if(values==NULL)
+        return NULL;
+
+    *size=0;
+    for(char *s=open+1; *s&&*s!='}';) {
+        if(isspace((unsigned char) *s)||*s==',') {
+            ++s;
+            continue;
+        }
+
+        char *next;
+        const long v=strtol(s, &next, 0);
+        if(next==s||v<0||v>255) {
+            free(values);
+            return NULL;
+        }
+        values[(*size)++]=v;
+        s=next;
+    }
+
+    return values;
+}
+
+int convert_to_proportional(const uint8_t *font, size_t size, const char *name, FILE *out) {
+    if(size<5||font[0]==0||font[3]>font[4]) {
+        fprintf(stderr, "The font header is invalid!\n");
+        return -1;
+    }
+
+    const size_t pages=(font[0]>>3)+((font[0]&7)>0), glyph_size=font[1]*pages;
+    const size_t glyphs=font[4]-font[3]+1;
+    if(size<5+glyphs*glyph_size) {
+        fprintf(stderr, "The font has less data than its header announces!\n");
+        return -1;
+    }
+
+    uint8_t *data=malloc(glyphs*glyph_size+1);
+    size_t *offsets=malloc((glyphs+1)*sizeof(size_t));
+    if(data==NULL||offsets==NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        free(data);
+        free(offsets);
+        return -1;
+    }
+
+    size_t data_size=0;
+    for(size_t i=0; i<glyphs; ++i) {
+        const uint8_t *glyph=font+5+i*glyph_size;
+        size_t first=font[1], last=0;
+        for(size_t w=0; w<font[1]; ++w) {
+            for(size_t k=0; k<pages; ++k) {
+                if(glyph[w*pages+k]) {
+                    if(w<first)
+                        first=w;
+                    last=w+1;
+                }
+            }
+        }
+
+        offsets[i]=data_size;
+        if(first<last) {
+            memcpy(data+data_size, glyph+first*pages, (last-first)*pages);
+            data_size+=(last-first)*pages;
+        } else {
+            memset(data+data_size, 0, (font[1]+1)/2*pages);
+            data_size+=(font[1]+1)/2*pages;
+        }
+    }
+    offsets[glyphs]=data_size;
+
+    if(data_size>UINT16_MAX) {
+        fprintf(stderr, "The font is too large for 16 bit offsets!\n");
+        free(data);
+        free(offsets);
+        return -1;
+    }
+
+    // chars of fixed width fonts often carry their spacing in empty columns
+    const uint8_t spacing=font[2]?font[2]:1;
+
+    fprintf(out, "// %zu bytes as fixed width font\nconst uint8_t %s_prop[]={\n0, 1, %u, %u, %u, %u,\n",
+            5+glyphs*glyph_size, name, font[0], spacing, font[3], font[4]);
+    for(size_t i=0; i<=glyphs; ++i)
+        fprintf(out, "0x%02x,0x%02x,%s", (unsigned) (offsets[i]&0xFF), (unsigned) (offsets[i]>>8), (i&7)==7||i==glyphs?"\n":"");
+    for(size_t i=0; i<data_size; ++i)
+        fprintf(out, i+1<data_size?"0x%02x,%s":"0x%02x\n", data[i], (i&15)==15?"\n":"");
+    fprintf(out, "};\n");
+
+    free(data);
+    free(offsets);
+
+    return 0;
+}
+
+int main(int ac, char *as[]) {
+    if(ac<2||ac>3) {
+        fprintf(stderr, "Usage: %s [input font header] [output file?]\n", as[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in=NULL, *out=NULL;
+    char *src=NULL;
+    uint8_t *font=NULL;
+    char name[256];
+    size_t size;
+
+    if((in=fopen(as[1], "r"))==NULL) {
+        fprintf(stderr, "Could not open \"%s\" for reading!\n", as[1]);
+        goto fail;
+    }
+
+    if((src=read_file(in))==NULL) {
+        fprintf(stderr, "Could not read \"%s\"!\n", as[1]);
+        goto fail;
+    }
+
+    strip_comments(src);
+    if((font=parse_array(src, name, sizeof(name), &size))==NULL) {
+        fprintf(stderr, "No font array found in \"%s\"!\n", as[1]);
+        goto fail;
+    }
+
+    if(ac==3) {
+        if((out=fopen(as[2], "w"))==NULL) {
+            fprintf(stderr, "Could not open \"%s\" for writing!\n", as[2]);
+            goto fail;
+        }
+    } else
+        out=stdout;
+
+    int res=convert_to_proportional(font, size, name, out);
+
+    free(font);
+    free(src);
+
+    fclose(in);
+    fclose(out);
+
+    return res?EXIT_FAILURE:EXIT_SUCCESS;
+
+fail:
+    free(font);
+    free(src);
+    if(in)
+        fclose(in);
+    if(out)
+        fclose(out);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <ctype.h>
+
+/*
+ * Converts a font header like font.h into the format of
+ * ssd1306_draw_string_with_rle_font: the 5 header bytes of the font,
+ * a little endian 16 bit offset per GROUP chars counted from the end of the
+ * offsets, then the <width>*<pages> column bytes of the chars run length
+ * encoded like in bmp2rle. Each group is encoded on its own, so it can be
+ * decoded from its start.
+ */
+
+#define GROUP 16	// SSD1306_RLE_FONT_GROUP
+
+size_t rle_encode(const uint8_t *in, size_t n, uint8_t *out) {
+    size_t o=0;
+
+    for(size_t i=0; i<n;) {
+        size_t run=1;
+        while(i+run<n&&run<129&&in[i+run]==in[i])
+            ++run;
+
+        if(run>=2) {
+            out[o++]=126+run;
+            out[o++]=in[i];
+            i+=run;
+            continue;
+        }
+
+        // a run of two costs as much as two literals, only longer ones end the literals
+        const size_t start=i;
+        while(i<n&&i-start<128&&!(i+2<n&&in[i]==in[i+1]&&in[i]==in[i+2]))
+            ++i;
+        out[o++]=i-start-1;
+        memcpy(out+o, in+start, i-start);
+        o+=i-start;
+    }
+
+    return o;
+}
+
+char *read_file(FILE *in) {
+    fseek(in, 0, SEEK_END);
+    const size_t size=ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    char *data=malloc(size+1);
+    if(data==NULL)
+        return NULL;
+
+    if(fread(data, 1, size, in)!=size) {
+        free(data);
+        return NULL;
+    }
+    data[size]=0;
+
+    return data;
+}
+
+/*
+ * Blanks out comments, they may contain braces and digits.
+ */
+void strip_comments(char *s) {
+    for(; *s; ++s) {
+        if(s[0]=='/'&&s[1]=='/') {
+            for(; *s&&*s!='\n'; ++s)
+                *s=' ';
+            if(*s==0)
+                break;
+        } else if(s[0]=='/'&&s[1]=='*') {
+            for(; *s&&!(s[0]=='*'&&s[1]=='/'); ++s)
+                *s=' ';
+            if(*s==0)
+                break;
+            s[0]=s[1]=' ';
+        }
+    }
+}
+
+/*
+ * Reads the name and the values of the first array initializer.
+ */
+uint8_t *parse_array(char *src, char *name, size_t name_size, size_t *size) {
+    char *open=strchr(src, '{'), *bracket=strchr(src, '[');
+    if(open==NULL||bracket==NULL||bracket>open)
+        return NULL;
+
+    char *end=bracket;
+    while(end>src&&isspace((unsigned char) end[-1]))
+        --end;
+    char *begin=end;
+    while(begin>src&&(isalnum((unsigned char) begin[-1])||begin[-1]=='_'))
+        --begin;
+    if(begin==end||(size_t) (end-begin)>=name_size)
+        return NULL;
+    memcpy(name, begin, end-begin);
+    name[end-begin]=0;
+
+    uint8_t *values=malloc(strlen(open));
+    if(values==NULL)
+        return NULL;
+
+    *size=0;
+    for(char *s=open+1; *s&&*s!='}';) {
+        if(isspace((unsigned char) *s)||*s==',') {
+            ++s;
+            continue;
+        }
+
+        char *next;
+        const long v=strtol(s, &next, 0);
+        if(next==s||v<0||v>255) {
+            free(values);
+            return NULL;
+        }
+        values[(*size)++]=v;
+        s=next;
+    }
+
+    return values;
+}
+
+int convert_to_rle(const uint8_t *font, size_t size, const char *name, FILE *out) {
+    if(size<5||font[3]>font[4]) {
+        fprintf(stderr, "The font header is invalid!\n");
+        return -1;
+    }
+
+    if(font[0]==0) {
+        fprintf(stderr, "Only fixed width fonts can be compressed!\n");
+        return -1;
+    }
+
+    const size_t pages=(font[0]>>3)+((font[0]&7)>0), glyph_size=font[1]*pages;
+    const size_t glyphs=font[4]-font[3]+1;
+    if(size<5+glyphs*glyph_size) {
+        fprintf(stderr, "The font has less data than its header announces!\n");
+        return -1;
+    }
+
+    const size_t groups=(glyphs+GROUP-1)/GROUP;
+    uint8_t *rle=malloc(glyphs*glyph_size+glyphs*glyph_size/128+groups);
+    size_t *offsets=malloc(groups*sizeof(size_t));
+    if(rle==NULL||offsets==NULL) {
+        fprintf(stderr, "Out of memory!\n");
+        free(rle);
+        free(offsets);
+        return -1;
+    }
+
+    size_t rle_size=0;
+    bool too_large=false;
+    for(size_t i=0; i<groups; ++i) {
+        const size_t n=(i+1)*GROUP<glyphs?GROUP:glyphs-i*GROUP;
+        too_large|=rle_size>UINT16_MAX;
+        offsets[i]=rle_size;
+        rle_size+=rle_encode(font+5+i*GROUP*glyph_size, n*glyph_size, rle+rle_size);
+    }
+
+    if(too_large) {
+        fprintf(stderr, "The compressed font is too large for 16 bit offsets!\n");
+        free(rle);
+        free(offsets);
+        return -1;
+    }
+
+    fprintf(out, "// %zu bytes uncompressed\nconst uint8_t %s_rle[]={\n%u, %u, %u, %u, %u,\n",
+            5+glyphs*glyph_size, name, font[0], font[1], font[2], font[3], font[4]);
+    for(size_t i=0; i<groups; ++i)
+        fprintf(out, "0x%02x,0x%02x,%s", (unsigned) (offsets[i]&0xFF), (unsigned) (offsets[i]>>8), (i&7)==7||i+1==groups?"\n":"");
+    for(size_t i=0; i<rle_size; ++i)
+        fprintf(out, i+1<rle_size?"0x%02x,%s":"0x%02x\n", rle[i], (i&15)==15?"\n":"");
+    fprintf(out, "};\n");
+
+    free(rle);
+    free(offsets);
+
+    return 0;
+}
+
+int main(int ac, char *as[]) {
+    if(ac<2||ac>3) {
+        fprintf(stderr, "Usage: %s [input font header] [output file?]\n", as[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *in=NULL, *out=NULL;
+    char *src=NULL;
+    uint8_t *font=NULL;
+    char name[256];
+    size_t size;
+
+    if((in=fopen(as[1], "r"))==NULL) {
+        fprintf(stderr, "Could not open \"%s\" for reading!\n", as[1]);
+        goto fail;
+    }
+
+    if((src=read_file(in))==NULL) {
+        fprintf(stderr, "Could not read \"%s\"!\n", as[1]);
+        goto fail;
+    }
+
+    strip_comments(src);
+    if((font=parse_array(src, name, sizeof(name), &size))==NULL) {
+        fprintf(stderr, "No font array found in \"%s\"!\n", as[1]);
+        goto fail;
+    }
+
+    if(ac==3) {
+        if((out=fopen(as[2], "w"))==NULL) {
+            fprintf(stderr, "Could not open \"%s\" for writing!\n", as[2]);
+            goto fail;
+        }
+    } else
+        out=stdout;
+
+    int res=convert_to_rle(font, size, name, out);
+
+    free(font);
+    free(src);
+
+    fclose(in);
+    fclose(out);
+
+    return res?EXIT_FAILURE:EXIT_SUCCESS;
+
+fail:
+    free(font);
+    free(src);
+    if(in)
+        fclose(in);
+    if(out)
+        fclose(out);
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,248 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "mock.h"
+#include "../../example/image.h"
+
+/*
+ * Host benchmark and golden framebuffer check of the drawing code.
+ *
+ * Every scene is drawn from the same pseudo random calls at each rotation
+ * of a 128x64 display. The time per scene is the average over -n runs.
+ * With -s the framebuffers (and the I2C stream of a show) are saved to a
+ * directory, with -c they are compared bit for bit against saved ones.
+ */
+
+#define WIDTH 128
+#define HEIGHT 64
+
+typedef struct {
+    const char *name;
+    void (*draw)(ssd1306_t *p, uint32_t *seed);
+} scene_t;
+
+static uint32_t rnd(uint32_t *seed, uint32_t n) {
+    // xorshift32, the same sequence on every host
+    *seed^=*seed<<13;
+    *seed^=*seed>>17;
+    *seed^=*seed<<5;
+    return *seed%n;
+}
+
+static void draw_pixels(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<1000; ++i)
+        ssd1306_draw_pixel(p, rnd(seed, WIDTH), rnd(seed, WIDTH));
+}
+
+static void draw_lines(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<100; ++i)
+        ssd1306_draw_line(p, rnd(seed, WIDTH+20)-10, rnd(seed, WIDTH+20)-10, rnd(seed, WIDTH+20)-10, rnd(seed, WIDTH+20)-10);
+}
+
+static void draw_squares(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<50; ++i)
+        ssd1306_draw_square(p, rnd(seed, WIDTH), rnd(seed, WIDTH), rnd(seed, 40), rnd(seed, 40));
+}
+
+static void draw_empty_squares(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<50; ++i)
+        ssd1306_draw_empty_square(p, rnd(seed, WIDTH), rnd(seed, WIDTH), rnd(seed, 40), rnd(seed, 40));
+}
+
+static void draw_circles(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<20; ++i)
+        ssd1306_draw_circle(p, rnd(seed, WIDTH), rnd(seed, WIDTH), rnd(seed, 20));
+}
+
+static void draw_empty_circles(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<20; ++i)
+        ssd1306_draw_empty_circle(p, rnd(seed, WIDTH), rnd(seed, WIDTH), rnd(seed, 20));
+}
+
+static void draw_chars(ssd1306_t *p, uint32_t *seed, uint32_t scale) {
+    for(int i=0; i<100; ++i)
+        ssd1306_draw_char(p, rnd(seed, WIDTH), rnd(seed, WIDTH), scale, ' '+rnd(seed, 95));
+}
+
+static void draw_chars_x1(ssd1306_t *p, uint32_t *seed) {
+    draw_chars(p, seed, 1);
+}
+
+static void draw_chars_x2(ssd1306_t *p, uint32_t *seed) {
+    draw_chars(p, seed, 2);
+}
+
+static void draw_chars_x4(ssd1306_t *p, uint32_t *seed) {
+    draw_chars(p, seed, 4);
+}
+
+static void draw_strings(ssd1306_t *p, uint32_t *seed, uint32_t scale) {
+    char s[22];
+
+    for(int i=0; i<20; ++i) {
+        const uint32_t n=rnd(seed, sizeof(s));
+        for(uint32_t k=0; k<n; ++k)
+            s[k]=' '+rnd(seed, 95);
+        s[n]=0;
+        ssd1306_draw_string(p, rnd(seed, WIDTH), rnd(seed, WIDTH), scale, s);
+    }
+}
+
+static void draw_strings_x1(ssd1306_t *p, uint32_t *seed) {
+    draw_strings(p, seed, 1);
+}
+
+static void draw_strings_x2(ssd1306_t *p, uint32_t *seed) {
+    draw_strings(p, seed, 2);
+}
+
+static void draw_strings_x3(ssd1306_t *p, uint32_t *seed) {
+    draw_strings(p, seed, 3);
+}
+
+static void draw_strings_x3_cached(ssd1306_t *p, uint32_t *seed) {
+    static uint8_t pool[4096];
+    static ssd1306_glyph_cache_t cache;
+
+    if(cache.pool==NULL)
+        ssd1306_glyph_cache_init(&cache, pool, sizeof(pool));
+
+    ssd1306_set_glyph_cache(p, &cache);
+    draw_strings(p, seed, 3);
+    ssd1306_set_glyph_cache(p, NULL);
+}
+
+static void draw_bmp(ssd1306_t *p, uint32_t *seed) {
+    for(int i=0; i<4; ++i)
+        ssd1306_bmp_show_image_with_offset(p, image_data, image_size, rnd(seed, WIDTH/2), rnd(seed, HEIGHT/2));
+}
+
+static const scene_t scenes[]= {
+    {"pixel", draw_pixels},
+    {"line", draw_lines},
+    {"square", draw_squares},
+    {"empty_square", draw_empty_squares},
+    {"circle", draw_circles},
+    {"empty_circle", draw_empty_circles},
+    {"char_x1", draw_chars_x1},
+    {"char_x2", draw_chars_x2},
+    {"char_x4", draw_chars_x4},
+    {"string_x1", draw_strings_x1},
+    {"string_x2", draw_strings_x2},
+    {"string_x3", draw_strings_x3},
+    {"string_x3_cached", draw_strings_x3_cached},
+    {"bmp", draw_bmp},
+};
+
+/*
+ * Saves data to dir/name.r<rotation>.bin or compares it with that file.
+ * Returns false on a mismatch or an I/O error.
+ */
+static bool golden(const char *dir, bool save, const char *name, int rotation, const uint8_t *data, size_t size) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s.r%d.bin", dir, name, rotation);
+
+    FILE *f=fopen(path, save?"wb":"rb");
+    if(f==NULL) {
+        fprintf(stderr, "Could not open \"%s\"!\n", path);
+        return false;
+    }
+
+    bool ok;
+    if(save)
+        ok=fwrite(data, 1, size, f)==size;
+    else {
+        uint8_t *ref=malloc(size+1);
+        const size_t n=ref?fread(ref, 1, size+1, f):0;
+        ok=ref&&n==size&&memcmp(ref, data, size)==0;
+        if(ref&&n==size&&!ok) {
+            size_t i=0;
+            while(ref[i]==data[i])
+                ++i;
+            fprintf(stderr, "%s: first difference at byte %zu\n", path, i);
+        } else if(!ok)
+            fprintf(stderr, "%s: %zu bytes instead of %zu\n", path, n, size);
+        free(ref);
+    }
+
+    fclose(f);
+    return ok;
+}
+
+int main(int ac, char *as[]) {
+    const char *dir=NULL;
+    bool save=false;
+    int runs=200;
+
+    for(int i=1; i<ac; ++i) {
+        if((strcmp(as[i], "-s")==0||strcmp(as[i], "-c")==0)&&i+1<ac) {
+            save=as[i][1]=='s';
+            dir=as[++i];
+        } else if(strcmp(as[i], "-n")==0&&i+1<ac&&atoi(as[i+1])>0)
+            runs=atoi(as[++i]);
+        else {
+            fprintf(stderr, "Usage: %s [-n runs] [-s dir | -c dir]\n", as[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    ssd1306_t disp;
+    disp.external_vcc=false;
+    if(!ssd1306_init(&disp, WIDTH, HEIGHT, 0x3C, i2c0)) {
+        fprintf(stderr, "Could not initialize the display!\n");
+        return EXIT_FAILURE;
+    }
+
+    static uint8_t stream[4096];
+    int failed=0;
+
+    printf("%-18s %8s %8s %8s %8s\n", "scene", "r0 us", "r1 us", "r2 us", "r3 us");
+    for(size_t k=0; k<sizeof(scenes)/sizeof(*scenes); ++k) {
+        printf("%-18s", scenes[k].name);
+
+        for(int rotation=0; rotation<4; ++rotation) {
+            ssd1306_set_rotation(&disp, rotation);
+            ssd1306_clear(&disp);
+
+            // every run draws the same pixels, the scenes only set them
+            const uint64_t start=time_us_64();
+            for(int i=0; i<runs; ++i) {
+                uint32_t seed=0x2545F491u+k;
+                scenes[k].draw(&disp, &seed);
+            }
+            printf(" %8.2f", (double) (time_us_64()-start)/runs);
+
+            if(dir&&!golden(dir, save, scenes[k].name, rotation, disp.buffer, disp.bufsize))
+                ++failed;
+
+            if(dir&&k+1==sizeof(scenes)/sizeof(*scenes)) {
+                mock_i2c_reset(stream, sizeof(stream));
+                ssd1306_show(&disp);
+                if(!golden(dir, save, "show", rotation, stream, mock_i2c.captured))
+                    ++failed;
+            }
+        }
+        printf("\n");
+    }
+
+    mock_i2c_reset(NULL, 0);
+    const uint64_t start=time_us_64();
+    for(int i=0; i<runs; ++i)
+        ssd1306_show(&disp);
+    printf("show: %.2f us, %zu bytes in %zu transactions\n", (double) (time_us_64()-start)/runs, mock_i2c.bytes/runs, mock_i2c.transactions/runs);
+
+    ssd1306_deinit(&disp);
+
+    if(dir&&save)
+        printf("saved to %s\n", dir);
+    else if(dir&&failed)
+        printf("%d framebuffers differ from %s\n", failed, dir);
+    else if(dir)
+        printf("all framebuffers match %s\n", dir);
+
+    return failed?EXIT_FAILURE:EXIT_SUCCESS;
+}
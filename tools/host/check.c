@@ -0,0 +1,710 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "ssd1306.h"
+#include "ssd1306_list.h"
+#include "mock.h"
+
+/*
+ * Host tests of the drawing and transfer code, run by make test.
+ *
+ * Drawing is compared against a naive reference that decides every pixel
+ * of a call on its own, at each rotation, drawing mode and with clipping.
+ * Shows, the shadow diff, scrolling, display lists and bands are checked
+ * against the display RAM of the controller model in mock.c. Every test
+ * prints its first mismatch and the number of the scene it is in.
+ */
+
+#define WIDTH 128
+#define HEIGHT 64
+#define SCENES 200
+
+extern const uint8_t font_8x5[];
+
+/*
+ * Reference image of a display in the coordinates of its rotation.
+ */
+typedef struct {
+    uint8_t px[WIDTH][WIDTH];	// [y][x], big enough for every rotation
+    int32_t w, h;	// size at the rotation
+    int32_t cx0, cy0, cx1, cy1;	// clip rectangle, empty if cx0>cx1
+    uint8_t mode;	// SSD1306_DRAW_* of the draw calls
+} ref_t;
+
+static uint32_t rnd(uint32_t *seed, uint32_t n) {
+    // xorshift32, the same sequence on every host
+    *seed^=*seed<<13;
+    *seed^=*seed>>17;
+    *seed^=*seed<<5;
+    return *seed%n;
+}
+
+static void ref_init(ref_t *r, uint8_t rotation) {
+    memset(r->px, 0, sizeof(r->px));
+    r->w=rotation&1?HEIGHT:WIDTH;
+    r->h=rotation&1?WIDTH:HEIGHT;
+    r->cx0=r->cy0=0;
+    r->cx1=r->w-1;
+    r->cy1=r->h-1;
+    r->mode=SSD1306_DRAW_SET;
+}
+
+static void ref_set_clip(ref_t *r, int32_t x, int32_t y, int32_t width, int32_t height) {
+    r->cx0=x;
+    r->cy0=y;
+    r->cx1=x+width-1<r->w-1?x+width-1:r->w-1;
+    r->cy1=y+height-1<r->h-1?y+height-1:r->h-1;
+}
+
+static void ref_plot(ref_t *r, int64_t x, int64_t y, uint8_t mode) {
+    if(x<r->cx0||x>r->cx1||y<r->cy0||y>r->cy1)
+        return;
+
+    uint8_t *px=&r->px[y][x];
+    *px=mode==SSD1306_DRAW_SET?1:mode==SSD1306_DRAW_CLEAR?0:!*px;
+}
+
+static void ref_fill(ref_t *r, int64_t x, int64_t y, int64_t width, int64_t height, uint8_t mode) {
+    for(int64_t j=0; j<height&&y+j<r->h; ++j)
+        for(int64_t i=0; i<width&&x+i<r->w; ++i)
+            ref_plot(r, x+i, y+j, mode);
+}
+
+static void ref_empty_square(ref_t *r, int64_t x, int64_t y, int64_t width, int64_t height) {
+    for(int64_t j=0; j<=height; ++j)
+        for(int64_t i=0; i<=width; ++i)
+            if(i==0||j==0||i==width||j==height)
+                ref_plot(r, x+i, y+j, r->mode);
+}
+
+static void ref_line(ref_t *r, int32_t x1, int32_t y1, int32_t x2, int32_t y2) {
+    const int32_t dx=abs(x2-x1), sx=x1<x2?1:-1, dy=-abs(y2-y1), sy=y1<y2?1:-1;
+
+    for(int32_t err=dx+dy;;) {
+        ref_plot(r, x1, y1, r->mode);
+        if(x1==x2&&y1==y2)
+            break;
+        const int32_t e2=2*err;
+        if(e2>=dy) {
+            err+=dy;
+            x1+=sx;
+        }
+        if(e2<=dx) {
+            err+=dx;
+            y1+=sy;
+        }
+    }
+}
+
+static void ref_circle(ref_t *r, int64_t x, int64_t y, int64_t rad) {
+    for(int64_t dy=1-rad; dy<rad; ++dy)
+        for(int64_t dx=1-rad; dx<rad; ++dx)
+            if(dx*dx+dy*dy<=rad*rad)
+                ref_plot(r, x+dx, y+dy, r->mode);
+}
+
+static void ref_empty_circle(ref_t *r, int64_t x, int64_t y, int64_t rad) {
+    static uint8_t mark[3*WIDTH][3*WIDTH];
+
+    if(rad==0)
+        return;
+    memset(mark, 0, sizeof(mark));
+
+    // the eight points of the midpoint algorithm are collected first, so each is drawn once
+    for(int64_t a=rad-1, b=0, err=2-rad; a>=b; ++b) {
+        const int64_t pts[8][2]= {{a, b}, {-a, b}, {a, -b}, {-a, -b}, {b, a}, {-b, a}, {b, -a}, {-b, -a}};
+        for(int k=0; k<8; ++k)
+            mark[WIDTH+y+pts[k][1]][WIDTH+x+pts[k][0]]=1;
+        if(err<0)
+            err+=2*(b+1)+1;
+        else {
+            --a;
+            err+=2*(b+1-a)+1;
+        }
+    }
+
+    for(int64_t j=0; j<3*WIDTH; ++j)
+        for(int64_t i=0; i<3*WIDTH; ++i)
+            if(mark[j][i])
+                ref_plot(r, i-WIDTH, j-WIDTH, r->mode);
+}
+
+static int64_t ref_char(ref_t *r, int64_t x, int64_t y, int64_t scale, char c, uint8_t mode) {
+    if(c>=font_8x5[3]&&c<=font_8x5[4]) {
+        const uint8_t *col=font_8x5+5+(c-font_8x5[3])*font_8x5[1];
+        for(int i=0; i<font_8x5[1]; ++i)
+            for(int bit=0; bit<8; ++bit)
+                if(col[i]>>bit&1)
+                    ref_fill(r, x+i*scale, y+bit*scale, scale, scale, mode);
+    }
+    return x+(font_8x5[1]+font_8x5[2])*scale;
+}
+
+/*
+ * Returns the pixel of the buffer of p at x, y of its rotation.
+ */
+static int buffer_pixel(const ssd1306_t *p, int32_t x, int32_t y) {
+    const int32_t w=p->width, h=p->height;
+    int32_t bx=x, by=y;
+
+    if(p->rotation==1)
+        bx=w-1-y, by=x;
+    else if(p->rotation==2)
+        bx=w-1-x, by=h-1-y;
+    else if(p->rotation==3)
+        bx=y, by=h-1-x;
+
+    return p->buffer[bx+w*(by>>3)]>>(by&7)&1;
+}
+
+static bool check_ref(const char *test, uint32_t scene, const ssd1306_t *p, const ref_t *r) {
+    for(int32_t y=0; y<r->h; ++y)
+        for(int32_t x=0; x<r->w; ++x)
+            if(buffer_pixel(p, x, y)!=r->px[y][x]) {
+                fprintf(stderr, "%s: scene %u, rotation %u: pixel %d,%d is %d\n", test, scene, p->rotation, x, y, !r->px[y][x]);
+                return false;
+            }
+    return true;
+}
+
+/*
+ * Compares the panel with a buffer of the unrotated display.
+ */
+static bool check_panel(const char *test, uint32_t scene, const uint8_t *buffer) {
+    for(uint32_t y=0; y<HEIGHT; ++y)
+        for(uint32_t x=0; x<WIDTH; ++x)
+            if(mock_ssd1306_pixel(x, y)!=(buffer[x+WIDTH*(y>>3)]>>(y&7)&1)) {
+                fprintf(stderr, "%s: scene %u: panel pixel %u,%u is %d\n", test, scene, x, y, mock_ssd1306_pixel(x, y));
+                return false;
+            }
+    return true;
+}
+
+/*
+ * Draws n random calls into p and, if r is not NULL, into the reference.
+ */
+static void scene(ssd1306_t *p, ref_t *r, uint32_t *seed, int n) {
+    const int32_t w=p->rotation&1?HEIGHT:WIDTH, h=p->rotation&1?WIDTH:HEIGHT;
+
+    for(int i=0; i<n; ++i) {
+        const uint32_t op=rnd(seed, 12);
+        const int32_t x=rnd(seed, w+20), y=rnd(seed, h+20), a=rnd(seed, 40), b=rnd(seed, 40);
+
+        if(op==0) {
+            const uint8_t mode=rnd(seed, 3);
+            ssd1306_set_draw_mode(p, mode);
+            if(r)
+                r->mode=mode;
+        } else if(op==1) {
+            ssd1306_draw_pixel(p, x, y);
+            if(r)
+                ref_plot(r, x, y, r->mode);
+        } else if(op==2) {
+            // lines start and end off the display as well
+            const int32_t x2=rnd(seed, w+20)-10, y2=rnd(seed, h+20)-10;
+            ssd1306_draw_line(p, x-10, y-10, x2, y2);
+            if(r)
+                ref_line(r, x-10, y-10, x2, y2);
+        } else if(op==3) {
+            ssd1306_draw_square(p, x, y, a, b);
+            if(r)
+                ref_fill(r, x, y, a, b, r->mode);
+        } else if(op==4) {
+            ssd1306_draw_empty_square(p, x, y, a, b);
+            if(r)
+                ref_empty_square(r, x, y, a, b);
+        } else if(op==5) {
+            ssd1306_clear_square(p, x, y, a, b);
+            if(r)
+                ref_fill(r, x, y, a, b, SSD1306_DRAW_CLEAR);
+        } else if(op==6) {
+            ssd1306_invert_square(p, x, y, a, b);
+            if(r)
+                ref_fill(r, x, y, a, b, SSD1306_DRAW_XOR);
+        } else if(op==7) {
+            ssd1306_draw_circle(p, x, y, a/2);
+            if(r)
+                ref_circle(r, x, y, a/2);
+        } else if(op==8) {
+            ssd1306_draw_empty_circle(p, x, y, a/2);
+            if(r)
+                ref_empty_circle(r, x, y, a/2);
+        } else if(op==9) {
+            const char c=' '+rnd(seed, 96);
+            const uint32_t scale=1+rnd(seed, 3);
+            ssd1306_draw_char(p, x, y, scale, c);
+            if(r)
+                ref_char(r, x, y, scale, c, r->mode);
+        } else if(op==10) {
+            char s[12];
+            const uint32_t len=rnd(seed, sizeof(s)), scale=1+rnd(seed, 2);
+            for(uint32_t k=0; k<len; ++k)
+                s[k]=' '+rnd(seed, 95);
+            s[len]=0;
+            ssd1306_draw_string(p, x, y, scale, s);
+            int64_t xn=x;
+            for(uint32_t k=0; r&&k<len; ++k)
+                xn=ref_char(r, xn, y, scale, s[k], r->mode);
+        } else if(b<4) {
+            ssd1306_clear(p);
+            if(r)
+                ref_fill(r, 0, 0, r->w, r->h, SSD1306_DRAW_CLEAR);
+        }
+    }
+
+    ssd1306_set_draw_mode(p, SSD1306_DRAW_SET);
+    if(r)
+        r->mode=SSD1306_DRAW_SET;
+}
+
+/*
+ * Sets the same random clip rectangle on p and the reference, or none.
+ */
+static void random_clip(ssd1306_t *p, ref_t *r, uint32_t *seed) {
+    const int32_t w=p->rotation&1?HEIGHT:WIDTH, h=p->rotation&1?WIDTH:HEIGHT;
+
+    if(rnd(seed, 3)) {
+        ssd1306_reset_clip(p);
+        if(r)
+            ref_set_clip(r, 0, 0, w, h);
+        return;
+    }
+
+    const int32_t x=rnd(seed, w), y=rnd(seed, h), cw=1+rnd(seed, w), ch=1+rnd(seed, h);
+    ssd1306_set_clip(p, x, y, cw, ch);
+    if(r)
+        ref_set_clip(r, x, y, cw, ch);
+}
+
+static bool test_draw(ssd1306_t *p) {
+    static ref_t r;
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0x2545F491u+k;
+
+        ssd1306_set_rotation(p, k%4);
+        ssd1306_clear(p);
+        ref_init(&r, k%4);
+        random_clip(p, &r, &seed);
+        scene(p, &r, &seed, 40);
+        if(!check_ref("draw", k, p, &r))
+            return false;
+    }
+
+    ssd1306_set_rotation(p, 0);
+    return true;
+}
+
+static bool test_copy(ssd1306_t *a, ssd1306_t *b) {
+    static ref_t ra, rb, src;
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0x9E3779B9u+k;
+
+        ssd1306_set_rotation(a, k%4);
+        ssd1306_set_rotation(b, k%4);
+        ssd1306_clear(a);
+        ssd1306_clear(b);
+        ref_init(&ra, k%4);
+        ref_init(&rb, k%4);
+        scene(a, &ra, &seed, 30);
+        scene(b, &rb, &seed, 30);
+        random_clip(b, &rb, &seed);
+
+        // from a into b or within b, rectangles reach past the edges of both
+        const bool within=rnd(&seed, 2);
+        const int32_t x=rnd(&seed, rb.w+40)-20, y=rnd(&seed, rb.h+40)-20;
+        const int32_t sx=rnd(&seed, rb.w+40)-20, sy=rnd(&seed, rb.h+40)-20;
+        const int32_t w=rnd(&seed, rb.w), h=rnd(&seed, rb.h);
+
+        src=within?rb:ra;
+        ssd1306_copy_square(b, x, y, within?b:a, sx, sy, w, h);
+        for(int32_t j=0; j<h; ++j)
+            for(int32_t i=0; i<w; ++i)
+                if(sx+i>=0&&sx+i<src.w&&sy+j>=0&&sy+j<src.h&&x+i<rb.w&&y+j<rb.h)
+                    ref_plot(&rb, x+i, y+j, src.px[sy+j][sx+i]?SSD1306_DRAW_SET:SSD1306_DRAW_CLEAR);
+        if(!check_ref("copy", k, b, &rb))
+            return false;
+
+        // pixels moved into the clip rectangle from outside of it are cleared
+        const int32_t dx=rnd(&seed, 41)-20, dy=rnd(&seed, 41)-20;
+        src=rb;
+        ssd1306_shift(b, dx, dy);
+        for(int32_t j=rb.cy0; j<=rb.cy1; ++j)
+            for(int32_t i=rb.cx0; i<=rb.cx1; ++i) {
+                const bool in=i-dx>=rb.cx0&&i-dx<=rb.cx1&&j-dy>=rb.cy0&&j-dy<=rb.cy1;
+                rb.px[j][i]=in?src.px[j-dy][i-dx]:0;
+            }
+        if(!check_ref("shift", k, b, &rb))
+            return false;
+    }
+
+    ssd1306_set_rotation(a, 0);
+    ssd1306_set_rotation(b, 0);
+    ssd1306_reset_clip(b);
+    return true;
+}
+
+static bool test_show(ssd1306_t *p) {
+    mock_ssd1306_reset(0x55);
+    ssd1306_clear(p);
+    ssd1306_show(p);
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0x6C8E9CF5u+k;
+
+        if(k==SCENES/2&&!ssd1306_enable_shadow(p)) {
+            fprintf(stderr, "show: no memory for the shadow\n");
+            return false;
+        }
+
+        ssd1306_set_rotation(p, k%4);
+        scene(p, NULL, &seed, 10);
+
+        // a failed transfer leaves the panel behind the shadow, the next show has to catch up
+        const bool fail=rnd(&seed, 8)==0;
+        mock_i2c.result=fail?PICO_ERROR_GENERIC:0;
+        const int error=rnd(&seed, 2)?ssd1306_show(p):ssd1306_show_dirty(p);
+        mock_i2c.result=0;
+        if(fail) {
+            if(error!=PICO_ERROR_GENERIC) {
+                fprintf(stderr, "show: scene %u: failed transfer returned %d\n", k, error);
+                return false;
+            }
+            ssd1306_show(p);
+        }
+
+        if(!check_panel("show", k, p->buffer))
+            return false;
+
+        mock_i2c_reset(NULL, 0);
+        ssd1306_show(p);
+        if(p->shadow&&mock_i2c.bytes) {
+            fprintf(stderr, "show: scene %u: %zu bytes sent for an unchanged frame\n", k, mock_i2c.bytes);
+            return false;
+        }
+    }
+
+    ssd1306_set_rotation(p, 0);
+    return true;
+}
+
+static bool test_scroll(ssd1306_t *p) {
+    static uint8_t before[WIDTH*HEIGHT/8], expected[WIDTH*HEIGHT/8];
+
+    mock_ssd1306_reset(0x55);
+    ssd1306_clear(p);
+    ssd1306_show(p);
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0x1B873593u+k;
+
+        scene(p, NULL, &seed, 5);
+        ssd1306_show_dirty(p);
+        memcpy(before, p->buffer, sizeof(before));
+
+        // rows move up for positive counts, the rows moved in are cleared
+        const int32_t rows=rnd(&seed, 2*HEIGHT+21)-HEIGHT-10;
+        ssd1306_scroll_rows(p, rows);
+
+        memset(expected, 0, sizeof(expected));
+        for(int32_t y=0; y<HEIGHT; ++y)
+            if(y+rows>=0&&y+rows<HEIGHT)
+                for(int32_t x=0; x<WIDTH; ++x)
+                    if(before[x+WIDTH*((y+rows)>>3)]>>((y+rows)&7)&1)
+                        expected[x+WIDTH*(y>>3)]|=1<<(y&7);
+
+        if(memcmp(expected, p->buffer, sizeof(expected))) {
+            fprintf(stderr, "scroll: scene %u: buffer not scrolled by %d rows\n", k, rows);
+            return false;
+        }
+        if(!check_panel("scroll", k, p->buffer))
+            return false;
+    }
+
+    ssd1306_scroll_stop(p);
+    return true;
+}
+
+static bool test_list(ssd1306_t *p, ssd1306_t *direct) {
+    static uint8_t arena[4096];
+    ssd1306_list_t l;
+
+    if(!ssd1306_list_init(&l, p, arena, sizeof(arena))) {
+        fprintf(stderr, "list: init failed\n");
+        return false;
+    }
+    mock_ssd1306_reset(0x55);
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0x85EBCA6Bu+k;
+
+        ssd1306_set_rotation(p, k%4);
+        ssd1306_set_rotation(direct, k%4);
+        ssd1306_list_clear(&l);
+        ssd1306_clear(direct);
+
+        // the clip rectangle applies when the list is shown, the direct display clips while drawing
+        uint32_t clip=seed;
+        random_clip(p, NULL, &clip);
+        clip=seed;
+        random_clip(direct, NULL, &clip);
+
+        const int32_t w=p->rotation&1?HEIGHT:WIDTH, h=p->rotation&1?WIDTH:HEIGHT;
+        const int n=1+rnd(&seed, 30);
+        size_t mark=0;
+        for(int i=0; i<n; ++i) {
+            const uint32_t op=rnd(&seed, 6);
+            const int32_t x=rnd(&seed, w+20), y=rnd(&seed, h+20), a=rnd(&seed, 40), b=rnd(&seed, 40);
+            const uint8_t mode=rnd(&seed, 3);
+
+            // the commands after the mark are rewound, so only the ones before it are drawn directly
+            if(i==n/2)
+                mark=ssd1306_list_mark(&l);
+            ssd1306_t *d=i<n/2?direct:NULL;
+            ssd1306_set_draw_mode(p, mode);
+            ssd1306_set_draw_mode(direct, mode);
+
+            if(op==0) {
+                ssd1306_list_draw_line(&l, x-10, y-10, a*2-10, b*2-10);
+                if(d)
+                    ssd1306_draw_line(d, x-10, y-10, a*2-10, b*2-10);
+            } else if(op==1) {
+                ssd1306_list_draw_square(&l, x, y, a, b);
+                if(d)
+                    ssd1306_draw_square(d, x, y, a, b);
+            } else if(op==2) {
+                ssd1306_list_draw_empty_square(&l, x, y, a, b);
+                if(d)
+                    ssd1306_draw_empty_square(d, x, y, a, b);
+            } else if(op==3) {
+                ssd1306_list_draw_circle(&l, x, y, a/2);
+                if(d)
+                    ssd1306_draw_circle(d, x, y, a/2);
+            } else if(op==4) {
+                ssd1306_list_draw_empty_circle(&l, x, y, a/2);
+                if(d)
+                    ssd1306_draw_empty_circle(d, x, y, a/2);
+            } else {
+                char s[8];
+                const uint32_t scale=1+rnd(&seed, 2);
+                for(uint32_t c=0; c<sizeof(s)-1; ++c)
+                    s[c]=' '+rnd(&seed, 95);
+                s[sizeof(s)-1]=0;
+                ssd1306_list_draw_string(&l, x, y, scale, s);
+                if(d)
+                    ssd1306_draw_string(d, x, y, scale, s);
+            }
+        }
+        ssd1306_list_rewind(&l, mark);
+        ssd1306_set_draw_mode(p, SSD1306_DRAW_SET);
+        ssd1306_set_draw_mode(direct, SSD1306_DRAW_SET);
+
+        // a failed page show is reported, sending all pages again catches the panel up
+        const bool fail=rnd(&seed, 8)==0;
+        mock_i2c.result=fail?PICO_ERROR_GENERIC:0;
+        int error=ssd1306_list_show(&l);
+        mock_i2c.result=0;
+        if(error!=(fail?PICO_ERROR_GENERIC:PICO_OK)) {
+            fprintf(stderr, "list: scene %u: show returned %d\n", k, error);
+            return false;
+        }
+        if(fail) {
+            l.dirty=0xFF;
+            if(ssd1306_list_show(&l)!=PICO_OK) {
+                fprintf(stderr, "list: scene %u: the error was reported again\n", k);
+                return false;
+            }
+        }
+        ssd1306_reset_clip(p);
+        ssd1306_reset_clip(direct);
+
+        if(!check_panel("list", k, direct->buffer))
+            return false;
+    }
+
+    ssd1306_set_rotation(p, 0);
+    ssd1306_set_rotation(direct, 0);
+    return true;
+}
+
+/*
+ * Render function of test_bands: draws the scene seeded by band.arg and
+ * tries the calls refused inside of bands
+ */
+static bool bands_refused;
+static ssd1306_list_t bands_list;
+
+static void render(ssd1306_t *p, ssd1306_band_t band) {
+    uint32_t seed=*(const uint32_t *) band.arg;
+
+    // whole-buffer calls have to stay inside of the band
+    ssd1306_draw_square(p, 0, 0, WIDTH, WIDTH);
+    ssd1306_clear(p);
+    scene(p, NULL, &seed, 30);
+
+    bands_refused=bands_refused&&ssd1306_show(p)==PICO_ERROR_NOT_PERMITTED
+                  &&ssd1306_show_dirty(p)==PICO_ERROR_NOT_PERMITTED&&ssd1306_swap(p)==PICO_ERROR_NOT_PERMITTED
+                  &&!ssd1306_show_async(p)&&!ssd1306_enable_double_buffer(p)&&ssd1306_show_bands(p, NULL, 1, render, band.arg)==PICO_ERROR_NOT_PERMITTED
+                  &&ssd1306_list_show(&bands_list)==PICO_ERROR_NOT_PERMITTED;
+    ssd1306_scroll_rows(p, 8);
+}
+
+static bool test_bands(ssd1306_t *p, ssd1306_t *direct, uint8_t *shared) {
+    static uint8_t work[SSD1306_BANDS_SIZE(WIDTH, 8)+16], arena[64];
+
+    mock_ssd1306_reset(0x55);
+    bands_refused=true;
+    if(!ssd1306_list_init(&bands_list, p, arena, sizeof(arena))) {
+        fprintf(stderr, "bands: list init failed\n");
+        return false;
+    }
+
+    for(uint32_t k=0; k<SCENES; ++k) {
+        uint32_t seed=0xC2B2AE35u+k;
+        const uint8_t band_pages=1+rnd(&seed, 8);
+        const size_t size=SSD1306_BANDS_SIZE(WIDTH, band_pages);
+
+        if(k==SCENES/2&&!ssd1306_enable_shadow(p)) {
+            fprintf(stderr, "bands: no memory for the shadow\n");
+            return false;
+        }
+
+        ssd1306_set_rotation(p, k%4);
+        ssd1306_set_rotation(direct, k%4);
+        ssd1306_clear(direct);
+        uint32_t clip=seed;
+        random_clip(p, NULL, &clip);
+        clip=seed;
+        random_clip(direct, NULL, &clip);
+
+        // the direct display draws what the render function draws into each band
+        uint32_t s=seed;
+        ssd1306_draw_square(direct, 0, 0, WIDTH, WIDTH);
+        ssd1306_clear(direct);
+        scene(direct, NULL, &s, 30);
+
+        memset(shared, 0xAA, 1+WIDTH*HEIGHT/8);
+        memset(work, 0xA5, sizeof(work));
+        // a failed transfer is returned, the next frame is sent whole; seed is left to the render function
+        mock_i2c.failed=0;
+        mock_i2c.result=k%8==3?PICO_ERROR_GENERIC:0;
+        const int error=ssd1306_show_bands(p, work, band_pages, render, &seed);
+        const bool fail=mock_i2c.failed>0;
+        mock_i2c.result=0;
+        if(error!=(fail?PICO_ERROR_GENERIC:PICO_OK)) {
+            fprintf(stderr, "bands: scene %u: %u pages returned %d\n", k, band_pages, error);
+            return false;
+        }
+        if(fail&&ssd1306_show_bands(p, work, band_pages, render, &seed)!=PICO_OK) {
+            fprintf(stderr, "bands: scene %u: the error was returned again\n", k);
+            return false;
+        }
+
+        for(size_t i=size; i<sizeof(work); ++i)
+            if(work[i]!=0xA5) {
+                fprintf(stderr, "bands: scene %u: byte %zu after the work memory of %u pages written\n", k, i-size, band_pages);
+                return false;
+            }
+        for(size_t i=0; i<1+WIDTH*HEIGHT/8; ++i)
+            if(shared[i]!=0xAA) {
+                fprintf(stderr, "bands: scene %u: buffer of the display written\n", k);
+                return false;
+            }
+        if(!bands_refused) {
+            fprintf(stderr, "bands: scene %u: a show, swap or scroll ran in the render function\n", k);
+            return false;
+        }
+        ssd1306_reset_clip(p);
+        ssd1306_reset_clip(direct);
+        if(!check_panel("bands", k, direct->buffer))
+            return false;
+    }
+
+    ssd1306_set_rotation(p, 0);
+    ssd1306_set_rotation(direct, 0);
+    return true;
+}
+
+static bool test_font_version(ssd1306_t *p) {
+    // proportional 8 row font with the chars A of 2 columns and B of 1 column
+    const uint8_t v1[]= {0, SSD1306_FONT_V1, 8, 1, 'A', 'B', 0, 0, 2, 0, 3, 0, 0xFF, 0x81, 0xFF};
+    uint8_t v2[sizeof(v1)];
+
+    memcpy(v2, v1, sizeof(v1));
+    v2[1]=SSD1306_FONT_V1+1;
+
+    if(ssd1306_text_width(v1, 1, "AB")!=4||ssd1306_text_width(v2, 1, "AB")!=0) {
+        fprintf(stderr, "font version: widths %u and %u\n", ssd1306_text_width(v1, 1, "AB"), ssd1306_text_width(v2, 1, "AB"));
+        return false;
+    }
+
+    ssd1306_clear(p);
+    ssd1306_draw_string_with_font(p, 0, 0, 1, v1, "AB");
+    if(p->buffer[0]!=0xFF||p->buffer[1]!=0x81||p->buffer[2]!=0||p->buffer[3]!=0xFF) {
+        fprintf(stderr, "font version: version 1 font drawn wrong\n");
+        return false;
+    }
+
+    // an unknown layout is not guessed at
+    ssd1306_clear(p);
+    ssd1306_draw_string_with_font(p, 0, 0, 2, v2, "AB");
+    ssd1306_draw_char_with_font(p, 0, 0, 1, v2, 'A');
+    for(size_t i=0; i<p->bufsize; ++i)
+        if(p->buffer[i]) {
+            fprintf(stderr, "font version: font of version %u drawn\n", v2[1]);
+            return false;
+        }
+
+    return true;
+}
+
+static bool test_init_size(void) {
+    static uint8_t buffer[1+129*72/8];
+    ssd1306_t p;
+
+    // the row buffers and the start line ring hold at most 128 columns and 64 rows
+    p.external_vcc=false;
+    if(ssd1306_init_with_buffer(&p, 129, 64, 0x3C, i2c0, buffer)||ssd1306_init_with_buffer(&p, 128, 72, 0x3C, i2c0, buffer)) {
+        fprintf(stderr, "init: display larger than 128x64 accepted\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(void) {
+    static uint8_t shared[1+WIDTH*HEIGHT/8];
+    ssd1306_t a, b, bands;
+
+    a.external_vcc=b.external_vcc=bands.external_vcc=false;
+    if(!ssd1306_init(&a, WIDTH, HEIGHT, 0x3C, i2c0)||!ssd1306_init(&b, WIDTH, HEIGHT, 0x3C, i2c0)
+            ||!ssd1306_init_with_buffer(&bands, WIDTH, HEIGHT, 0x3C, i2c0, shared)) {
+        fprintf(stderr, "Could not initialize the displays!\n");
+        return EXIT_FAILURE;
+    }
+
+    int failed=0;
+    failed+=!test_init_size();
+    failed+=!test_draw(&a);
+    failed+=!test_copy(&a, &b);
+    failed+=!test_font_version(&a);
+    failed+=!test_list(&bands, &a);
+    failed+=!test_bands(&bands, &a, shared);
+    failed+=!test_show(&a);
+    failed+=!test_scroll(&b);
+
+    ssd1306_deinit(&a);
+    ssd1306_deinit(&b);
+    ssd1306_deinit(&bands);
+
+    if(failed)
+        printf("%d tests failed\n", failed);
+    else
+        printf("all tests passed\n");
+
+    return failed?EXIT_FAILURE:EXIT_SUCCESS;
+}
@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for hardware/dma.h, no channel can be claimed
+ */
+
+#ifndef _inc_host_hardware_dma
+#define _inc_host_hardware_dma
+#include "pico/stdlib.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size {
+    DMA_SIZE_8=0,
+    DMA_SIZE_16=1,
+    DMA_SIZE_32=2
+};
+
+typedef struct {
+    uint32_t ctrl;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(unsigned channel);
+dma_channel_config dma_channel_get_default_config(unsigned channel);
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size);
+void channel_config_set_read_increment(dma_channel_config *c, bool incr);
+void channel_config_set_write_increment(dma_channel_config *c, bool incr);
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq);
+void dma_channel_configure(unsigned channel, const dma_channel_config *c, volatile void *write_addr, const volatile void *read_addr, unsigned count, bool trigger);
+bool dma_channel_is_busy(unsigned channel);
+void dma_channel_set_irq0_enabled(unsigned channel, bool enabled);
+bool dma_channel_get_irq0_status(unsigned channel);
+void dma_channel_acknowledge_irq0(unsigned channel);
+
+#endif
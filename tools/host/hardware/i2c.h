@@ -0,0 +1,34 @@
+/*
+ * Host stand-in for hardware/i2c.h, writes go to the mock in mock.c
+ */
+
+#ifndef _inc_host_hardware_i2c
+#define _inc_host_hardware_i2c
+#include "pico/stdlib.h"
+
+typedef struct i2c_inst i2c_inst_t;
+
+typedef struct {
+    volatile uint32_t enable;
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t status;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t clr_stop_det;
+} i2c_hw_t;
+
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200u
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400u
+#define I2C_IC_STATUS_TFE_BITS 0x00000004u
+#define I2C_IC_STATUS_MST_ACTIVITY_BITS 0x00000020u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040u
+
+extern i2c_inst_t *i2c0, *i2c1;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_write_timeout_per_char_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, unsigned timeout_per_char_us);
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c);
+unsigned i2c_get_dreq(i2c_inst_t *i2c, bool is_tx);
+
+#endif
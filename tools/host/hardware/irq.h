@@ -0,0 +1,17 @@
+/*
+ * Host stand-in for hardware/irq.h, interrupts never fire
+ */
+
+#ifndef _inc_host_hardware_irq
+#define _inc_host_hardware_irq
+#include "pico/stdlib.h"
+
+#define DMA_IRQ_0 11
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+void irq_add_shared_handler(unsigned num, irq_handler_t handler, uint8_t order_priority);
+void irq_set_enabled(unsigned num, bool enabled);
+
+#endif
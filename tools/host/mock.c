@@ -0,0 +1,205 @@
+#include <string.h>
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "mock.h"
+
+struct i2c_inst {
+    i2c_hw_t hw;
+};
+
+static struct i2c_inst i2c_insts[2]= {
+    {.hw={.status=I2C_IC_STATUS_TFE_BITS}},
+    {.hw={.status=I2C_IC_STATUS_TFE_BITS}},
+};
+i2c_inst_t *i2c0=&i2c_insts[0], *i2c1=&i2c_insts[1];
+
+mock_i2c_t mock_i2c;
+mock_ssd1306_t mock_ssd1306;
+
+void mock_i2c_reset(uint8_t *capture, size_t capture_size) {
+    memset(&mock_i2c, 0, sizeof(mock_i2c));
+    mock_i2c.capture=capture;
+    mock_i2c.capture_size=capture_size;
+}
+
+void mock_ssd1306_reset(uint8_t fill) {
+    memset(&mock_ssd1306, 0, sizeof(mock_ssd1306));
+    memset(mock_ssd1306.ram, fill, sizeof(mock_ssd1306.ram));
+    mock_ssd1306.col1=127;
+    mock_ssd1306.page1=7;
+}
+
+int mock_ssd1306_pixel(uint32_t x, uint32_t y) {
+    const uint32_t row=(y+mock_ssd1306.start_line)&63;
+    return (mock_ssd1306.ram[row>>3][x&127]>>(row&7))&1;
+}
+
+// arguments following a command byte, 0 for commands without any
+static uint8_t mock_ssd1306_nargs(uint8_t cmd) {
+    switch(cmd) {
+    case 0x26: case 0x27:
+        return 6;
+    case 0x29: case 0x2A:
+        return 5;
+    case 0x21: case 0x22: case 0xA3:
+        return 2;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void mock_ssd1306_cmd(uint8_t b) {
+    mock_ssd1306_t *m=&mock_ssd1306;
+
+    if(m->pending) {
+        m->args[m->nargs-m->pending]=b;
+        if(--m->pending)
+            return;
+        if(m->cmd==0x21) {
+            m->col=m->col0=m->args[0]&127;
+            m->col1=m->args[1]&127;
+        } else if(m->cmd==0x22) {
+            m->page=m->page0=m->args[0]&7;
+            m->page1=m->args[1]&7;
+        }
+        return;
+    }
+
+    m->cmd=b;
+    m->nargs=m->pending=mock_ssd1306_nargs(b);
+    if(b>=0x40&&b<=0x7F)
+        m->start_line=b&63;
+}
+
+static void mock_ssd1306_write(const uint8_t *src, size_t len) {
+    mock_ssd1306_t *m=&mock_ssd1306;
+
+    // the first byte tells commands (0x00) from data (0x40)
+    for(size_t i=1; i<len; ++i) {
+        if(src[0]==0x00) {
+            mock_ssd1306_cmd(src[i]);
+            continue;
+        }
+
+        m->ram[m->page][m->col&127]=src[i];
+        if(m->col++==m->col1) {
+            m->col=m->col0;
+            m->page=m->page==m->page1?m->page0:(m->page+1)&7;
+        }
+    }
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void) i2c;
+    (void) addr;
+    (void) nostop;
+
+    if(mock_i2c.result<0) {
+        ++mock_i2c.failed;
+        return mock_i2c.result;
+    }
+
+    ++mock_i2c.transactions;
+    mock_i2c.bytes+=len;
+    mock_ssd1306_write(src, len);
+    if(mock_i2c.capture) {
+        const size_t n=len<mock_i2c.capture_size-mock_i2c.captured?len:mock_i2c.capture_size-mock_i2c.captured;
+        memcpy(mock_i2c.capture+mock_i2c.captured, src, n);
+        mock_i2c.captured+=n;
+    }
+
+    return len;
+}
+
+int i2c_write_timeout_per_char_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, unsigned timeout_per_char_us) {
+    (void) timeout_per_char_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) {
+    return &i2c->hw;
+}
+
+unsigned i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) {
+    (void) i2c;
+    (void) is_tx;
+    return 0;
+}
+
+// no DMA channel is ever handed out, so asynchronous shows fall back to blocking ones
+
+int dma_claim_unused_channel(bool required) {
+    (void) required;
+    return -1;
+}
+
+void dma_channel_unclaim(unsigned channel) {
+    (void) channel;
+}
+
+dma_channel_config dma_channel_get_default_config(unsigned channel) {
+    (void) channel;
+    return (dma_channel_config) {0};
+}
+
+void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) {
+    (void) c;
+    (void) size;
+}
+
+void channel_config_set_read_increment(dma_channel_config *c, bool incr) {
+    (void) c;
+    (void) incr;
+}
+
+void channel_config_set_write_increment(dma_channel_config *c, bool incr) {
+    (void) c;
+    (void) incr;
+}
+
+void channel_config_set_dreq(dma_channel_config *c, unsigned dreq) {
+    (void) c;
+    (void) dreq;
+}
+
+void dma_channel_configure(unsigned channel, const dma_channel_config *c, volatile void *write_addr, const volatile void *read_addr, unsigned count, bool trigger) {
+    (void) channel;
+    (void) c;
+    (void) write_addr;
+    (void) read_addr;
+    (void) count;
+    (void) trigger;
+}
+
+bool dma_channel_is_busy(unsigned channel) {
+    (void) channel;
+    return false;
+}
+
+void dma_channel_set_irq0_enabled(unsigned channel, bool enabled) {
+    (void) channel;
+    (void) enabled;
+}
+
+bool dma_channel_get_irq0_status(unsigned channel) {
+    (void) channel;
+    return false;
+}
+
+void dma_channel_acknowledge_irq0(unsigned channel) {
+    (void) channel;
+}
+
+void irq_add_shared_handler(unsigned num, irq_handler_t handler, uint8_t order_priority) {
+    (void) num;
+    (void) handler;
+    (void) order_priority;
+}
+
+void irq_set_enabled(unsigned num, bool enabled) {
+    (void) num;
+    (void) enabled;
+}
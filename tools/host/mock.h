@@ -0,0 +1,53 @@
+/*
+ * Mocked I2C bus of the host build: counts and records what is written
+ */
+
+#ifndef _inc_host_mock
+#define _inc_host_mock
+#include <stdint.h>
+#include <stddef.h>
+
+typedef struct {
+    size_t bytes;	// bytes written, control bytes included
+    size_t transactions;	// calls of i2c_write_blocking
+    uint8_t *capture;	// written bytes are appended here if not NULL
+    size_t capture_size;	// size of capture
+    size_t captured;	// bytes in capture
+    int result;	// returned instead of the length if negative
+    size_t failed;	// calls that returned result
+} mock_i2c_t;
+
+extern mock_i2c_t mock_i2c;
+
+/*
+ * Model of the controller: the RAM of a 128x64 display as the written
+ * commands and data leave it, in horizontal addressing mode
+ */
+typedef struct {
+    uint8_t ram[8][128];	// display RAM, one byte per column of a page
+    uint8_t start_line;	// RAM row shown in the top row of the panel
+    uint8_t col0, col1, page0, page1;	// column and page address windows
+    uint8_t col, page;	// position of the next data byte
+    uint8_t cmd;	// command whose arguments are read
+    uint8_t args[6];	// arguments read so far
+    uint8_t nargs, pending;	// arguments of cmd, arguments still to read
+} mock_ssd1306_t;
+
+extern mock_ssd1306_t mock_ssd1306;
+
+/*
+ * Forgets the counters and starts recording into capture.
+ */
+void mock_i2c_reset(uint8_t *capture, size_t capture_size);
+
+/*
+ * Fills the display RAM with a byte and resets the addressing.
+ */
+void mock_ssd1306_reset(uint8_t fill);
+
+/*
+ * Returns the pixel shown in column x, row y of the panel.
+ */
+int mock_ssd1306_pixel(uint32_t x, uint32_t y);
+
+#endif
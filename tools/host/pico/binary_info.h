@@ -0,0 +1,3 @@
+/*
+ * Host stand-in for pico/binary_info.h, nothing is recorded
+ */
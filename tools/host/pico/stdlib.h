@@ -0,0 +1,31 @@
+/*
+ * Host stand-in for the parts of the pico-sdk used by ssd1306.c
+ */
+
+#ifndef _inc_host_pico_stdlib
+#define _inc_host_pico_stdlib
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+#define PICO_ERROR_NOT_PERMITTED -4
+#define PICO_ERROR_INVALID_ARG -5
+
+static inline uint64_t time_us_64(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec*1000000u+t.tv_nsec/1000u;
+}
+
+static inline void sleep_ms(uint32_t ms) {
+    (void) ms;
+}
+
+static inline void tight_loop_contents(void) {
+}
+
+#endif